@@ -12,4 +12,12 @@ g_undirected = deepcopy(g)
 g_undirected.makeUndirected()
 g_undirected.computeWCC()
 
-print("Diameter BD", g_undirected.diameterBD())
\ No newline at end of file
+print("Diameter BD", g_undirected.diameterBD())
+# Graphs can also be built from NumPy arrays, which are read without copying
+import numpy as np
+
+sources = np.array([0, 1, 2, 2], dtype=np.int64)
+targets = np.array([1, 2, 0, 3], dtype=np.int64)
+h = Graph(sources, targets)
+print("PageRank", h.pageRankCentrality())  # a NumPy array
+print("Neighbors of 2", h.neighbors(2))  # a read-only view on the adjacency list
@@ -0,0 +1,225 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Compressed sparse row (CSR) adjacency lists: the neighbors of node i are
+ * stored contiguously in targets[offsets[i] .. offsets[i+1]). The arrays are
+ * either owned by the object or borrowed from memory that outlives it, such
+ * as a memory-mapped snapshot.
+ *
+ * Sorted lists can additionally be compressed: each list is then stored as
+ * byte-aligned varints, namely its length, the first neighbor relative to the
+ * node itself, and the gaps between consecutive neighbors. NodeSpan iterates
+ * both forms, decoding compressed lists on the fly.
+ */
+
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <teexgraph/IndexTypes.h> // node id and list position types
+
+namespace teexgraph {
+
+// read an unsigned LEB128 varint at p and advance p past it
+inline unsignednodeindextype readVarint(const unsigned char * & p) {
+    unsignednodeindextype value = *p & 0x7F;
+    for(int shift = 7; *p++ & 0x80; shift += 7)
+        value |= (unsignednodeindextype)(*p & 0x7F) << shift;
+    return value;
+} // readVarint
+
+
+// read-only view on a list of node ids, either a contiguous array or a
+// compressed list that is decoded while iterating
+class NodeSpan {
+  public:
+    class iterator {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef nodeindextype value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const nodeindextype * pointer;
+        typedef nodeindextype reference;
+
+        iterator() = default;
+        explicit iterator(const nodeindextype * p) : p(p) {}
+        iterator(const unsigned char * bytes, const nodeindextype value, const nodeindextype remaining) :
+                bytes(bytes), value(value), remaining(remaining) {}
+
+        nodeindextype operator*() const { return bytes == nullptr ? *p : value; }
+        iterator & operator++() {
+            if(bytes == nullptr)
+                p++;
+            else if(--remaining > 0)
+                value += 1 + (nodeindextype) readVarint(bytes);
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const iterator & other) const { return p == other.p && remaining == other.remaining; }
+        bool operator!=(const iterator & other) const { return !(*this == other); }
+
+      private:
+        const nodeindextype * p = nullptr; // plain lists
+        const unsigned char * bytes = nullptr; // compressed lists: next gap,
+        nodeindextype value = 0, remaining = 0; // current neighbor and number of neighbors left
+    };
+
+    NodeSpan() = default;
+    NodeSpan(const nodeindextype * first, const nodeindextype * last) : first(first), last(last) {}
+    NodeSpan(const unsigned char * bytes, const nodeindextype count, const nodeindextype node) :
+            bytes(bytes), count(count), node(node) {}
+
+    iterator begin() const {
+        if(bytes == nullptr)
+            return iterator(first);
+        if(count == 0)
+            return iterator();
+        const unsigned char * p = bytes;
+        const unsignednodeindextype zigzag = readVarint(p);
+        return iterator(p, node + (nodeindextype)((zigzag >> 1) ^ (0 - (zigzag & 1))), count);
+    }
+    iterator end() const { return bytes == nullptr ? iterator(last) : iterator(); }
+    const nodeindextype * data() const { return first; } // nullptr for a compressed list
+    size_t size() const { return bytes == nullptr ? last - first : count; }
+    bool empty() const { return size() == 0; }
+    bool isCompressed() const { return bytes != nullptr; }
+    // constant time for plain lists, linear time for compressed lists
+    nodeindextype operator[](const size_t i) const {
+        if(bytes == nullptr)
+            return first[i];
+        iterator it = begin();
+        for(size_t j = 0; j < i; j++)
+            ++it;
+        return *it;
+    }
+
+  private:
+    const nodeindextype * first = nullptr;
+    const nodeindextype * last = nullptr;
+    const unsigned char * bytes = nullptr;
+    nodeindextype count = 0, node = 0;
+};
+
+
+class Adjacency {
+  public:
+    Adjacency();
+    Adjacency(const Adjacency &);
+    Adjacency & operator=(const Adjacency &);
+    Adjacency(Adjacency &&);
+    Adjacency & operator=(Adjacency &&);
+
+    // neighbors of node i
+    NodeSpan operator[](const nodeindextype i) const {
+        if(compressed) {
+            const unsigned char * p = bytes.data() + byteOffsets[i];
+            const nodeindextype size = readVarint(p);
+            return NodeSpan(p, size, i);
+        }
+        return NodeSpan(targetData + offsetData[i], targetData + offsetData[i + 1]);
+    }
+    NodeSpan at(const nodeindextype) const;
+    template <typename Visit>
+    void forEach(const nodeindextype, Visit) const;
+    nodeindextype degree(const nodeindextype i) const {
+        if(compressed) {
+            const unsigned char * p = bytes.data() + byteOffsets[i];
+            return readVarint(p);
+        }
+        return offsetData[i + 1] - offsetData[i];
+    }
+    nodeindextype nodes() const { return count; }
+    edgeindextype edges() const { return compressed ? edgeCount : offsetData[count]; }
+    bool isCompressed() const { return compressed; }
+    size_t memoryBytes() const;
+    // plain lists only
+    const edgeindextype * offsetArray() const { return offsetData; }
+    const nodeindextype * targetArray() const { return targetData; }
+
+    void clear();
+    void empty(const nodeindextype);
+    template <typename Id>
+    void build(const nodeindextype, const std::vector< std::vector<Id> > &, const bool);
+    void unite(const Adjacency &);
+    void update(const Adjacency &, const nodeindextype, const Adjacency &, const Adjacency &);
+    void permute(const std::vector<nodeindextype> &);
+    edgeindextype sortUnique();
+    void view(const nodeindextype, const edgeindextype *, const nodeindextype *);
+    void compress();
+    void decompress();
+
+  private:
+    std::vector<edgeindextype> offsets; // owned storage, unused for a view
+    std::vector<nodeindextype> targets;
+    const edgeindextype * offsetData; // where the lists are actually read from
+    const nodeindextype * targetData;
+    nodeindextype count; // number of nodes
+    bool compressed; // lists are in bytes instead of the arrays above
+    std::vector<long> byteOffsets; // compressed list i starts at bytes[byteOffsets[i]]
+    std::vector<unsigned char> bytes;
+    edgeindextype edgeCount;
+
+    void own();
+};
+
+
+// call visit(j) for every neighbor j of node i in order. unlike iterating a
+// NodeSpan, this chooses between plain and compressed lists once per list,
+// which keeps the traversal kernels as fast as before for plain lists
+template <typename Visit>
+void Adjacency::forEach(const nodeindextype i, Visit visit) const {
+    if(!compressed) {
+        const nodeindextype * end = targetData + offsetData[i + 1];
+        for(const nodeindextype * p = targetData + offsetData[i]; p != end; ++p)
+            visit(*p);
+        return;
+    }
+    const unsigned char * p = bytes.data() + byteOffsets[i];
+    const nodeindextype size = readVarint(p);
+    if(size == 0)
+        return;
+    const unsignednodeindextype zigzag = readVarint(p);
+    nodeindextype j = i + (nodeindextype)((zigzag >> 1) ^ (0 - (zigzag & 1)));
+    visit(j);
+    for(nodeindextype k = 1; k < size; k++) {
+        j += 1 + (nodeindextype) readVarint(p);
+        visit(j);
+    }
+} // forEach
+
+
+// build the adjacency of nodes 0, ..., nodes-1 from buffers of [u v u v ...]
+// pairs in two passes: count the degrees, then fill each list in input order.
+// with reverse set, the lists hold the sources of edges instead of the targets
+template <typename Id>
+void Adjacency::build(const nodeindextype nodes, const std::vector< std::vector<Id> > & buffers, const bool reverse) {
+    const int from = reverse ? 1 : 0, to = reverse ? 0 : 1;
+
+    offsets.assign(nodes + 1, 0);
+    for(size_t i = 0; i < buffers.size(); i++)
+        for(size_t j = 0; j < buffers[i].size(); j += 2)
+            offsets[buffers[i][j + from] + 1]++;
+    for(nodeindextype i = 0; i < nodes; i++)
+        offsets[i + 1] += offsets[i];
+
+    std::vector<edgeindextype> next(offsets.begin(), offsets.end() - 1);
+    targets.resize(offsets[nodes]);
+    for(size_t i = 0; i < buffers.size(); i++)
+        for(size_t j = 0; j < buffers[i].size(); j += 2)
+            targets[next[buffers[i][j + from]]++] = buffers[i][j + to];
+
+    count = nodes;
+    own();
+} // build
+
+}
+
+#endif /* ADJACENCY_H */
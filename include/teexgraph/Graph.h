@@ -10,24 +10,32 @@
 #include <algorithm> // min, max, etc.
 #include <cassert> // min, max, etc.
 #include <climits> // INT_MAX etc.
+#include <cstdint> // seeds
 #include <cstdlib>
 #include <fstream> // file reading/writing
 #include <iomanip> // setw()
 #include <iostream> // cout, clog, cerr, etc.
+#include <memory> // shared_ptr
 #include <string> // filenames etc.
 #include <omp.h> // openMP paralellization
 #include <queue> // BFS
+#include <stdexcept> // exceptions of the templated loaders
 #include <stack> // DFS
-#include <unordered_map> // mapping node id's
 #include <vector> // node data structure
 
+#include <teexgraph/Adjacency.h> // CSR adjacency lists
+#include <teexgraph/NodeMapping.h> // mapping node id's
+#include <teexgraph/StringPool.h> // string node identifiers
+
 namespace teexgraph {
 
-// node datatype in input file. for optimal loading speed, use long or int (not string)
-typedef long nodeidtype;
+class DistanceIndex;
+class EdgeScanner;
+class MappedFile;
 
-// default max. node count; change here or by passing int to Graph constructor
-const int MAXN = 10000000;
+// integer node identifiers in the input file; string identifiers are selected
+// at runtime with IdMapping::STRING instead
+typedef long nodeidtype;
 
 // diferent scopes at which we can call functions: on the FULL network, on the
 // largest weakly (WCC) or strongly (SCC) connected component
@@ -44,11 +52,71 @@ enum class Extremum {
     CENTER_SIZE
 };
 
+// vertex orderings that reorder() can renumber the nodes by: by decreasing
+// degree, reverse Cuthill-McKee, or a Gorder-style ordering that puts nodes
+// with common neighbors close together
+enum class Ordering {
+    DEGREE, RCM, GORDER
+};
+
+// a batch of edge insertions and deletions, which is buffered until it is
+// applied to a graph with Graph::applyBatch(). the endpoints are input
+// identifiers: integers, or strings for graphs loaded with IdMapping::STRING.
+// deletions are applied before insertions; deleting an edge that does not
+// exist has no effect, and inserted identifiers that do not occur in the graph
+// become new nodes
+class EdgeBatch {
+  public:
+    void insertEdge(const nodeidtype u, const nodeidtype v) {
+        inserted.push_back(u);
+        inserted.push_back(v);
+    }
+    void deleteEdge(const nodeidtype u, const nodeidtype v) {
+        deleted.push_back(u);
+        deleted.push_back(v);
+    }
+    void insertEdge(const std::string & u, const std::string & v) {
+        insertedNames.push_back(u);
+        insertedNames.push_back(v);
+    }
+    void deleteEdge(const std::string & u, const std::string & v) {
+        deletedNames.push_back(u);
+        deletedNames.push_back(v);
+    }
+    size_t size() const {
+        return (inserted.size() + deleted.size() + insertedNames.size() + deletedNames.size()) / 2;
+    }
+    bool empty() const { return size() == 0; }
+    void clear() {
+        inserted.clear();
+        deleted.clear();
+        insertedNames.clear();
+        deletedNames.clear();
+    }
+
+  private:
+    friend class Graph;
+    std::vector<nodeidtype> inserted, deleted; // [u v u v ...]
+    std::vector<std::string> insertedNames, deletedNames;
+};
+
+// estimates of the neighborhood function of a graph, computed by
+// Graph::hyperBall(): the number of pairs of nodes at each distance, and per
+// node the harmonic and closeness centrality, over the nodes in scope
+struct NeighborhoodFunction {
+    std::vector<double> pairs; // pairs (u, v) with d(u, v) = 0, 1, 2, ..
+    std::vector<double> harmonic; // sum of 1 / d(u, v) over the nodes v reachable from u
+    std::vector<double> closeness; // nodes in scope divided by the sum of d(u, v), or 0
+
+    double averageDistance() const;
+    double effectiveDiameter(const double = 0.9) const;
+};
+
 class Graph {
   public:
     // initialization and loading
     Graph();
-    Graph(const int);
+    Graph(const nodeindextype);
     Graph(const std::string& filename, const bool directed);
     template<
         typename Integer, 
@@ -64,19 +132,37 @@ class Graph {
     void clear();
 
     // Loaders
-    bool loadDirected(const std::string);
-    bool loadUndirected(const std::string);
+    bool loadDirected(const std::string, const IdMapping = IdMapping::AUTO);
+    bool loadUndirected(const std::string, const IdMapping = IdMapping::AUTO);
+    bool loadDirectedFromFd(const int, const IdMapping = IdMapping::AUTO);
+    bool loadDirectedFromStream(std::istream &, const IdMapping = IdMapping::AUTO);
+    bool loadSnapshot(const std::string, const bool = false);
+    bool saveSnapshot(const std::string) const;
     template<
         typename Integer//,
 //        typename = typename std::enable_if<std::is_integral<Integer>::value, Integer>::type
     >
     void loadDirectedFromVectors(
         const std::vector<Integer>& sources,
-        const std::vector<Integer>& targets
+        const std::vector<Integer>& targets,
+        const IdMapping mapping = IdMapping::AUTO
+    );
+    template<
+        typename Integer
+    >
+    void loadDirectedFromArrays(
+        const Integer* sources,
+        const Integer* targets,
+        const size_t count,
+        const IdMapping mapping = IdMapping::AUTO
     );
 
     void makeUndirected();
-    bool inScope(const int, const Scope) const;
+    void compress();
+    void reorder(const Ordering);
+    bool applyBatch(const EdgeBatch &);
+    bool applyBatch(const EdgeBatch &, Graph &) const;
+    bool inScope(const nodeindextype, const Scope) const;
 
     // components
     void computeSCC();
@@ -88,63 +174,77 @@ class Graph {
     // basic topology
     double averageDegree(const Scope) const;
     double density(const Scope) const;
-    bool edge(const int, const int);
+    bool edge(const nodeindextype, const nodeindextype);
     long edges(const Scope) const;
-    int mapNode(const nodeidtype);
-    const std::vector<int> & neighbors(const int) const;
-    int nodes(const Scope) const;
-    int nodesInScc(const int) const;
-    int nodesInWcc(const int) const;
+    nodeindextype mapNode(const nodeidtype) const;
+    nodeindextype mapNode(const std::string &) const;
+    std::string nodeName(const nodeindextype) const;
+    NodeSpan neighbors(const nodeindextype) const;
+    nodeindextype nodes(const Scope) const;
+    nodeindextype nodesInScc(const nodeindextype) const;
+    nodeindextype nodesInWcc(const nodeindextype) const;
     double reciprocity(const Scope scope);
-    nodeidtype revMapNode(const int) const;
-    const std::vector<int> & revNeighbors(const int) const;
-    int sccCount() const;
+    nodeidtype revMapNode(const nodeindextype) const;
+    NodeSpan revNeighbors(const nodeindextype) const;
+    nodeindextype sccCount() const;
     long selfEdges(const Scope scope) const;
-    int wccCount() const;
-    int wccOf(const int) const;
+    nodeindextype wccCount() const;
+    nodeindextype wccOf(const nodeindextype) const;
 
     // status
     bool isLoaded() const;
     bool isUndirected() const;
     bool isSortedAndUnique() const;
+    bool isCompressed() const;
+    bool hasStringIds() const;
+    bool isSemiExternal() const;
+    bool hasDistanceIndex() const;
     bool sccComputed() const;
     bool wccComputed() const;
 
     // triangles and clustering
-    double averageClusteringCoefficient(const Scope, const double);
+    double averageClusteringCoefficient(const Scope, const double, const uint64_t = 0);
     double graphClusteringCoefficient(const Scope);
-    std::vector<double> localClustering(std::vector<int> &);
-    double nodeClusteringCoefficient(const int);
+    std::vector<double> localClustering(std::vector<nodeindextype> &);
+    double nodeClusteringCoefficient(const nodeindextype);
     long triangles(const Scope);
-    std::pair<long, long> trianglesWedgesAround(const int);
+    std::pair<long, long> trianglesWedgesAround(const nodeindextype);
     long wedges(const Scope);
 
     // distances, degree and compont size distributions
-    std::vector<long> distanceDistribution(const Scope, const double);
+    std::vector<long> distanceDistribution(const Scope, const double, const uint64_t = 0);
     std::vector<long> indegreeDistribution(const Scope);
     std::vector<long> outdegreeDistribution(const Scope);
-    std::vector<int> sccSizeDistribution();
-    std::vector<int> wccSizeDistribution();
+    std::vector<nodeindextype> sccSizeDistribution();
+    std::vector<nodeindextype> wccSizeDistribution();
 
     // distance metrics
-    int distance(const int, const int) const;
-    std::vector<int> distances(const int, std::vector<long> &) const;
-	std::vector<int> alldistances(const int);
-    double averageDistance(const Scope, const double);
+    nodeindextype distance(const nodeindextype, const nodeindextype) const;
+    std::vector<nodeindextype> shortestPath(const nodeindextype, const nodeindextype) const;
+    std::vector<nodeindextype> distances(const nodeindextype, std::vector<long> &) const;
+    std::vector<nodeindextype> distances(const std::vector< std::pair<nodeindextype, nodeindextype> > &) const;
+	std::vector<nodeindextype> alldistances(const nodeindextype);
+    double averageDistance(const Scope, const double, const uint64_t = 0);
+    NeighborhoodFunction hyperBall(const Scope, const int = 6) const;
+
+    // exact distance index for undirected graphs (see DistanceIndex.cpp)
+    bool buildDistanceIndex(const int = 16);
+    bool loadDistanceIndex(const std::string);
+    bool saveDistanceIndex(const std::string) const;
 
     // BoundingDiameters functions
-    int centerSizeBD();
-    int diameterAPSP();
-    int diameterBD();
-    std::vector<int> eccentricitiesAPSP();
-    std::vector<int> eccentricitiesBD();
-    int peripherySizeBD();
-    int radiusAPSP();
-    int radiusBD();
+    nodeindextype centerSizeBD();
+    nodeindextype diameterAPSP();
+    nodeindextype diameterBD();
+    std::vector<nodeindextype> eccentricitiesAPSP();
+    std::vector<nodeindextype> eccentricitiesBD();
+    nodeindextype peripherySizeBD();
+    nodeindextype radiusAPSP();
+    nodeindextype radiusBD();
 
 	// centrality
-    std::vector<double> betweennessCentrality(const Scope, const double);
-    std::vector<double> closenessCentrality(const Scope, const double);
+    std::vector<double> betweennessCentrality(const Scope, const double, const uint64_t = 0);
+    std::vector<double> closenessCentrality(const Scope, const double, const uint64_t = 0);
     std::vector<double> degreeCentrality();
     std::vector<double> eccentricityCentrality(const Scope);
     std::vector<double> indegreeCentrality();
@@ -153,26 +253,38 @@ class Graph {
 
   protected:
 
-    bool addEdge(const int, const int);
-    bool edgeSlow(const int, const int);
-    void goMarkSCC(const int, const int);
-    void goVisitSCC(const int, std::vector<bool> &, std::stack<int> &, std::vector<int> &, std::vector<int> &);
+    void addEdgeBuffers(std::vector< std::vector<nodeidtype> > &, const IdMapping, long &, long &);
+    bool edgeSlow(const nodeindextype, const nodeindextype);
+    void goMarkSCC(const nodeindextype, const nodeindextype);
+    void goVisitSCC(const nodeindextype, std::vector<bool> &, std::stack<nodeindextype> &);
+    bool loadEdgeBuffers(std::vector< std::vector<nodeidtype> > &, const IdMapping);
+    bool loadShards(const std::vector<std::string> &, const IdMapping);
+    bool loadStringTokens(const std::vector< std::vector<StringToken> > &);
+    template <typename Id>
+    void buildEdges(const std::vector< std::vector<Id> > &, const nodeindextype, long &, long &);
+    bool finishLoading(const long, const long);
+    nodeindextype mapBatch(const EdgeBatch &, std::vector<nodeindextype> &, std::vector<nodeindextype> &, Graph &) const;
     void sortEdgeList();
 
   private:
-
-    // graph data, always consistent
-    int maxn; // maximal number of nodes
-    std::unordered_map<nodeidtype, int> nodeMapping; // mapping of input node-identifiers to 0, .., n-1
-    std::unordered_map<int, nodeidtype> revMapping; // mapping 0, .., n-1 to input node-identifiers
-    std::vector< std::vector<int> > E; // list of out-neighbors of i
-    std::vector< std::vector<int> > rE; // list of in-neighbors of i
-
-    int n; // number of nodes
+    friend class VersionedGraph; // sorts the lists of the first version
+
+    // graph data, always consistent. the node mapping and string identifiers
+    // are not changed once built, so that versions of a graph (see
+    // applyBatch()) can share them
+    std::shared_ptr<const NodeMapping<nodeidtype> > nodeMapping; // mapping between input node-identifiers and 0, .., n-1
+    std::shared_ptr<const StringPool> names; // string identifier of node i, if stringIds
+    bool stringIds; // were the nodes loaded with IdMapping::STRING?
+    Adjacency E; // list of out-neighbors of i
+    Adjacency rE; // list of in-neighbors of i
+    std::shared_ptr<MappedFile> snapshot; // snapshot that E and rE may be read from
+    std::shared_ptr<EdgeScanner> scanner; // streams E from the snapshot file in semi-external mode
+    std::shared_ptr<const DistanceIndex> labels; // answers distance queries, if built
+
+    nodeindextype n; // number of nodes
     long m; // number of links
     std::vector<bool> hasSelfLoop; // true if node at index has a self-loop
     long selfm; // number of self-loops (self-edges)
-    int nexti; // next unused node id (finally equal to n)
 
     // graph type status
     bool loaded = false; // is the graph already loaded?
@@ -182,37 +294,51 @@ class Graph {
     bool doneWCC; // has the WCC for each node been computed?
 
     // Connected components
-    int largestWCC; // index of largest WCC
-    int largestSCC; // index of largest SCC
-    int wccs; // number of WCCs
-    int sccs; // number of WCCs
-    std::vector<int> wccId; // WCC # of node i
-    std::vector<int> wccNodes; // nr. of nodes in WCC i
+    nodeindextype largestWCC; // index of largest WCC
+    nodeindextype largestSCC; // index of largest SCC
+    nodeindextype wccs; // number of WCCs
+    nodeindextype sccs; // number of WCCs
+    std::vector<nodeindextype> wccId; // WCC # of node i
+    std::vector<nodeindextype> wccNodes; // nr. of nodes in WCC i
     std::vector<long> wccEdges; // nr. of edges in WCC i
-    std::vector<int> sccId; // SCC # of node i
-    std::vector<int> sccNodes; // nr. of nodes in SCC i
+    std::vector<nodeindextype> sccId; // SCC # of node i
+    std::vector<nodeindextype> sccNodes; // nr. of nodes in SCC i
     std::vector<long> sccEdges; // nr. of edges in SCC i
 
 	// helpers for sampling
-	double setSampleSize(int &, const Scope, const double);
-	std::vector<int> getSample(const int, const Scope);
+	double setSampleSize(nodeindextype &, const Scope, const double);
+	std::vector<nodeindextype> getSample(const nodeindextype, const Scope, const uint64_t);
 
     // BoundingDiameters functions:
-    int eccentricity(const int);
-    int extremaBounding(Extremum, const bool);
-    int pruning();
+    nodeindextype eccentricity(const nodeindextype);
+    nodeindextype extremaBounding(Extremum, const bool);
+    nodeindextype pruning();
+
+    // direction-optimizing breadth-first search (see Bfs.cpp)
+    std::vector<nodeindextype> bfs(const nodeindextype, const std::vector<nodeindextype> * = nullptr, const bool = false,
+            const std::vector<nodeindextype> * = nullptr) const;
+    nodeindextype bidirectionalBfs(const nodeindextype, const nodeindextype, std::vector<nodeindextype> * = nullptr,
+            long * = nullptr) const;
+    void multiBfs(const nodeindextype *, const int, std::vector<long> *, std::vector<long> *) const;
+
+    // incremental WCCs for applyBatch() (see Updates.cpp)
+    void updateWCC(const Graph &, const std::vector<nodeindextype> &);
+
+    // semi-external mode (see SemiExternal.cpp)
+    void computeWCCExternal();
+    nodeindextype eccentricityExternal(const nodeindextype);
+    std::vector<long> distanceCountsExternal(const std::vector<nodeindextype> &);
 
     // BoundingDiameters data:
-    std::vector<int> d; // for distance computation
-    std::vector<int> pruned; // -1 if not pruned, 0 or larger value if pruned by that particular node
-    std::vector<int> ecc_lower; // lower eccentricity bounds
-    std::vector<int> ecc_upper; // upper eccentricity bounds
+    std::vector<nodeindextype> d; // for distance computation
+    std::vector<nodeindextype> pruned; // -1 if not pruned, 0 or larger value if pruned by that particular node
+    std::vector<nodeindextype> ecc_lower; // lower eccentricity bounds
+    std::vector<nodeindextype> ecc_upper; // upper eccentricity bounds
     std::vector<bool> candidate; // candidate set for contributing to computing the extreme distance measures
 
 	// centrality
-    double closeness(const int);
-    std::vector<int> closenesses(const int, std::vector<long> &);
-    int closenessSum(const int);
+    double closeness(const nodeindextype);
+    long closenessSum(const nodeindextype);
 };
 
 
@@ -224,11 +350,29 @@ template<
 >
 void Graph::loadDirectedFromVectors(
     const std::vector<Integer>& sources,
-    const std::vector<Integer>& targets
+    const std::vector<Integer>& targets,
+    const IdMapping mapping
 ){
     if(sources.size()!=targets.size()){
         throw std::runtime_error("Sources and Targets must be of the same length!");
     }
+    loadDirectedFromArrays(sources.data(), targets.data(), sources.size(), mapping);
+}
+
+
+// load edges (sources[i], targets[i]) from memory owned by the caller, such
+// as NumPy arrays. the arrays are only read: the pairs are copied once into an
+// edge buffer of 2 * count identifiers, which is mapped to node ids and
+// freed once the adjacency lists are built
+template<
+    typename Integer
+>
+void Graph::loadDirectedFromArrays(
+    const Integer* sources,
+    const Integer* targets,
+    const size_t count,
+    const IdMapping mapping
+){
     long edgesAdded = 0;
     long edgesSkipped = 0;
 
@@ -236,30 +380,31 @@ void Graph::loadDirectedFromVectors(
     if(loaded) {
         throw std::runtime_error("Graph already loaded!");
     }
+    if(mapping == IdMapping::STRING) {
+        throw std::invalid_argument("String identifiers can only be loaded from edge list files and streams!");
+    }
 
-    maxn = sources.size();
     clear();
 
     // load the edge list
-    for(size_t i=0;i<sources.size();i++){
-        if(addEdge(mapNode(sources[i]), mapNode(targets[i]))){
-            edgesAdded++;
-        } else {
-            edgesSkipped++;
-        }
+    std::vector< std::vector<nodeidtype> > buffers(1);
+    buffers[0].resize(2 * count);
+    for(size_t i=0;i<count;i++){
+        buffers[0][2 * i] = sources[i];
+        buffers[0][2 * i + 1] = targets[i];
     }
+    addEdgeBuffers(buffers, mapping, edgesAdded, edgesSkipped);
 
     loaded = true;
 
     if(edgesSkipped == 0) {
         sortEdgeList();
     } else {
-        throw std::runtime_error("Out-of-bounds: increase maxn in Graph.h!");
+        throw std::runtime_error("Node identifiers could not be mapped to node ids!");
     }
 }
 
 
-
 }
 
 #endif /* GRAPH_H */
@@ -0,0 +1,37 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Integer types of the internal node ids 0, .., n-1 and of the positions in
+ * the adjacency lists. By default node ids are 32-bit, which allows for up to
+ * 2^31-1 nodes, and list positions are 64-bit, which allows for as many edges
+ * as fit in memory. Build with TEEXGRAPH_64BIT_NODES for graphs with more
+ * nodes, at the cost of twice the memory per edge, or with
+ * TEEXGRAPH_32BIT_EDGES to save memory on graphs with less than 2^31 edges.
+ * Node ids are signed, as -1 marks unvisited nodes and the like.
+ */
+
+#ifndef INDEXTYPES_H
+#define INDEXTYPES_H
+
+#include <type_traits>
+
+namespace teexgraph {
+
+#ifdef TEEXGRAPH_64BIT_NODES
+typedef long nodeindextype;
+#else
+typedef int nodeindextype;
+#endif
+
+#ifdef TEEXGRAPH_32BIT_EDGES
+typedef int edgeindextype;
+#else
+typedef long edgeindextype;
+#endif
+
+// node ids as stored in compressed lists
+typedef std::make_unsigned<nodeindextype>::type unsignednodeindextype;
+
+}
+
+#endif /* INDEXTYPES_H */
@@ -0,0 +1,62 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Mapping between the node identifiers of the input and node ids 0, .., n-1,
+ * stored as one flat table of identifiers. Identifiers that already are 0, ..,
+ * n-1 are used as node ids directly; other identifiers are numbered in sorted
+ * order, which is computed with a parallel sort-and-dedup instead of a hash map.
+ * The member functions are instantiated for nodeidtype in NodeMapping.cpp.
+ */
+
+#ifndef NODEMAPPING_H
+#define NODEMAPPING_H
+
+#include <type_traits>
+#include <vector>
+
+#include <teexgraph/IndexTypes.h> // node id type
+
+namespace teexgraph {
+
+// how input identifiers become node ids: detect dense identifiers 0, .., n-1
+// automatically, assume them (ids without edges become isolated nodes), or
+// always renumber in sorted order. STRING reads arbitrary string identifiers
+// instead of integers, which are numbered in order of first occurrence per
+// hash shard (see StringPool.h)
+enum class IdMapping {
+    AUTO, DENSE, SPARSE, STRING
+};
+
+template <typename Id>
+class NodeMapping {
+  public:
+    NodeMapping() { clear(); }
+
+    void clear();
+    nodeindextype size() const { return ids.size(); }
+    bool isDense() const { return dense; }
+    const Id & operator[](const nodeindextype i) const { return ids[i]; }
+    const Id & at(const nodeindextype i) const { return ids.at(i); }
+    const std::vector<Id> & table() const { return ids; }
+
+    nodeindextype find(const Id &) const;
+    void assign(std::vector<Id> &&);
+    void extend(const NodeMapping &, const std::vector<Id> &);
+    bool mapEdges(std::vector< std::vector<Id> > &, const IdMapping);
+
+  private:
+    std::vector<Id> ids; // input identifier of node i
+    std::vector<nodeindextype> order; // node ids sorted by identifier; empty if ids is sorted
+    bool dense; // ids[i] == i for all i
+
+    void index();
+    bool mapDense(std::vector< std::vector<Id> > &, const IdMapping, std::true_type);
+    bool mapDense(std::vector< std::vector<Id> > &, const IdMapping, std::false_type);
+    void mapSparse(std::vector< std::vector<Id> > &);
+    nodeindextype findDense(const Id &, std::true_type) const;
+    nodeindextype findDense(const Id &, std::false_type) const;
+};
+
+}
+
+#endif /* NODEMAPPING_H */
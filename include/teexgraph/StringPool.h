@@ -0,0 +1,80 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Interned node identifiers for edge lists with string identifiers (see
+ * IdMapping::STRING). All strings are stored once, back to back in a single
+ * arena, and are found through an open-addressing hash table with linear
+ * probing that holds node ids only. String i is the identifier of node i.
+ */
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <teexgraph/IndexTypes.h> // node id type
+
+namespace teexgraph {
+
+// hash a string of length bytes, eight bytes at a time
+inline uint64_t hashString(const char * p, size_t length) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ length;
+    for(; length >= 8; p += 8, length -= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        h = (h ^ word) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    uint64_t word = 0;
+    memcpy(&word, p, length);
+    h = (h ^ word) * 0xC4CEB9FE1A85EC53ULL;
+    return h ^ (h >> 29);
+} // hashString
+
+
+// a string in the input, with its hash
+struct StringToken {
+    const char * data;
+    uint32_t length;
+    uint64_t hash;
+};
+
+
+class StringPool {
+  public:
+    StringPool() { clear(); }
+
+    void clear();
+    nodeindextype size() const { return offsets.size() - 1; }
+    std::string operator[](const nodeindextype i) const {
+        return std::string(chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    std::string at(const nodeindextype) const;
+    nodeindextype find(const std::string &) const;
+    nodeindextype find(const char *, const size_t, const uint64_t) const;
+    nodeindextype intern(const char *, const size_t, const uint64_t);
+    std::vector< std::vector<nodeindextype> > internTokens(const std::vector< std::vector<StringToken> > &);
+    void permute(const std::vector<nodeindextype> &);
+    void extend(const StringPool &, const std::vector<std::string> &);
+
+    // arena and offsets, e.g. for snapshots
+    const std::vector<char> & arena() const { return chars; }
+    const std::vector<long> & offsetTable() const { return offsets; }
+    void assign(std::vector<char> &&, std::vector<long> &&);
+
+  private:
+    std::vector<char> chars; // all strings back to back
+    std::vector<long> offsets; // string i is chars[offsets[i] .. offsets[i+1])
+    std::vector<uint64_t> hashes; // hash of string i, to grow the table without rehashing
+    std::vector<nodeindextype> slots; // node id per slot or -1; the size is a power of two
+
+    void append(const StringPool &);
+    void index();
+};
+
+}
+
+#endif /* STRINGPOOL_H */
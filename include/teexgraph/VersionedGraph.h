@@ -0,0 +1,38 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Versions of a graph that is updated in batches (see EdgeBatch), RCU-style:
+ * readers take the current version with current() and keep seeing exactly
+ * that graph for as long as they hold it, while a writer builds the next
+ * version from it and a batch (see Graph::applyBatch()) and then atomically
+ * publishes that version. Building it only reads the current version, so the
+ * lists are not copied first and the node mapping is shared between versions.
+ * A version is freed when its last reader lets go of it. Versions are shared
+ * between threads, so readers may only call const member functions on them.
+ */
+
+#ifndef VERSIONEDGRAPH_H
+#define VERSIONEDGRAPH_H
+
+#include <memory>
+#include <mutex>
+
+#include <teexgraph/Graph.h>
+
+namespace teexgraph {
+
+class VersionedGraph {
+  public:
+    explicit VersionedGraph(Graph &&);
+
+    std::shared_ptr<const Graph> current() const;
+    bool apply(const EdgeBatch &);
+
+  private:
+    std::shared_ptr<const Graph> version; // only accessed with atomic_load and atomic_store
+    std::mutex writer; // one batch at a time
+};
+
+}
+
+#endif /* VERSIONEDGRAPH_H */
@@ -53,7 +53,7 @@ void printNodeList(
     const std::vector<Number> & values,
     const Scope scope = Scope::FULL
 ) {
-    std::vector<int> emptyfilter(n, 0);
+    std::vector<nodeindextype> emptyfilter(n, 0);
     if(scope == Scope::LSCC)
         printFilteredNodeList(values, sccId, largestSCC);
     else if(scope == Scope::LWCC)
@@ -69,7 +69,7 @@ void printNodeMultiList(
     const std::vector< std::vector<Number> > & values,
     const Scope scope = Scope::FULL
 ) {
-    std::vector<int> emptyfilter(values[0].size(), 0);
+    std::vector<nodeindextype> emptyfilter(values[0].size(), 0);
     if(scope == Scope::LSCC)
         printFilteredNodeMultiList(values, sccId, largestSCC);
     else if(scope == Scope::LWCC)
@@ -83,13 +83,13 @@ void printNodeMultiList(
 template <typename Number>
 void printFilteredNodeMultiList(
     const std::vector< std::vector<Number> > & values,
-    const std::vector<int> & targetfilter,
-    const int targetvalue
+    const std::vector<nodeindextype> & targetfilter,
+    const nodeindextype targetvalue
 ) {
     long double count = 0;
     for(size_t i = 0; i < values[0].size(); i++)
         if(targetfilter[i] == targetvalue) {
-            std::cout << revMapNode(i);
+            std::cout << nodeName(i);
             for(size_t j = 0; j < values.size(); j++)
                 std::cout << '\t' << values[j][i]; // to print node lists
             std::cout << std::endl;
@@ -103,14 +103,14 @@ void printFilteredNodeMultiList(
 template <typename Number>
 void printFilteredNodeList(
     const std::vector<Number> & values,
-    std::vector<int> & targetfilter,
-    const int targetvalue
+    std::vector<nodeindextype> & targetfilter,
+    const nodeindextype targetvalue
 ) {
     long double total = 0;
     double count = 0;
-    for(int i = 0; i < n; i++)
+    for(nodeindextype i = 0; i < n; i++)
         if(targetfilter[i] == targetvalue) {
-            std::cout << revMapNode(i) << '\t' << values[i] << std::endl; // to print node lists
+            std::cout << nodeName(i) << '\t' << values[i] << std::endl; // to print node lists
             total += values[i];
             count += 1;
         }
@@ -131,14 +131,14 @@ void printPythonNodeList(
     FILE *const myFile = fopen(filename.c_str(), "wb");
     Number total = 0;
     double count = 0;
-    for(int i = 0; i < n; i++) {
+    for(nodeindextype i = 0; i < n; i++) {
         if(inScope(i, scope)) {
             double tmp2 = values[i];
-            //cerr << revMapNode(i) << '\t' << values[i] << std::endl;
+            //cerr << nodeName(i) << '\t' << values[i] << std::endl;
             fwrite(&tmp2, sizeof (double), 1, myFile);
         }
     }
-    for(int i = 0; i < n; i++) {
+    for(nodeindextype i = 0; i < n; i++) {
         if(inScope(i, scope)) {
             double tmp = 0; // TODO: make stringready. revMapNode(i);
             fwrite(&tmp, sizeof (double), 1, myFile);
@@ -154,9 +154,9 @@ void printPythonNodeList(
 // print list of nodes according to some filter
 template <typename Number>
 void printNodes(const std::vector<Number> & targetfilter, const Number targetvalue) {
-    for(int i = 0; i < n; i++)
+    for(nodeindextype i = 0; i < n; i++)
         if(targetfilter[i] == targetvalue) {
-            std::cout << revMapNode(i) << std::endl;
+            std::cout << nodeName(i) << std::endl;
         }
 }
 
@@ -164,12 +164,12 @@ void printNodes(const std::vector<Number> & targetfilter, const Number targetval
 // print list of edges according to some filter
 template <typename Number>
 void printEdges(const std::vector<Number> & targetfilter, const Number targetvalue) {
-    for(int i = 0; i < n; i++) {
+    for(nodeindextype i = 0; i < n; i++) {
         if(targetfilter[i] == targetvalue) {
-            const int z = (signed)E[i].size();
-            for(int j = 0; j < z; j++)
+            const nodeindextype z = (signed)E[i].size();
+            for(nodeindextype j = 0; j < z; j++)
                 if(targetfilter[E[i][j]] == targetvalue)
-                    std::cout << revMapNode(i) << '\t' << revMapNode(E[i][j]) << std::endl;
+                    std::cout << nodeName(i) << '\t' << nodeName(E[i][j]) << std::endl;
         }
     }
 }
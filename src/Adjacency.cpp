@@ -0,0 +1,417 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Compressed sparse row (CSR) adjacency lists
+ */
+
+#include <teexgraph/Adjacency.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+using namespace teexgraph;
+
+Adjacency::Adjacency() {
+    clear();
+} // Adjacency constructor
+
+
+// copies own their data, unless the original is a view on external memory
+Adjacency::Adjacency(const Adjacency & other) {
+    *this = other;
+} // Adjacency copy constructor
+
+
+Adjacency & Adjacency::operator=(const Adjacency & other) {
+    if(this == &other)
+        return *this;
+    offsets = other.offsets;
+    targets = other.targets;
+    count = other.count;
+    compressed = other.compressed;
+    byteOffsets = other.byteOffsets;
+    bytes = other.bytes;
+    edgeCount = other.edgeCount;
+    if(other.offsetData == other.offsets.data()) {
+        offsetData = offsets.data();
+        targetData = targets.data();
+    } else {
+        offsetData = other.offsetData;
+        targetData = other.targetData;
+    }
+    return *this;
+} // operator=
+
+
+// moves hand over the lists without copying them
+Adjacency::Adjacency(Adjacency && other) {
+    *this = move(other);
+} // Adjacency move constructor
+
+
+Adjacency & Adjacency::operator=(Adjacency && other) {
+    if(this == &other)
+        return *this;
+    offsets = move(other.offsets);
+    targets = move(other.targets);
+    offsetData = other.offsetData;
+    targetData = other.targetData;
+    count = other.count;
+    compressed = other.compressed;
+    byteOffsets = move(other.byteOffsets);
+    bytes = move(other.bytes);
+    edgeCount = other.edgeCount;
+    other.clear();
+    return *this;
+} // move assignment
+
+
+// neighbors of node i, with bounds checking
+NodeSpan Adjacency::at(const nodeindextype i) const {
+    if(i < 0 || i >= count)
+        throw out_of_range("node " + to_string(i) + " does not exist");
+    return (*this)[i];
+} // at
+
+
+// remove all nodes
+void Adjacency::clear() {
+    empty(0);
+} // clear
+
+
+// nodes 0, ..., nodes-1 without any edges
+void Adjacency::empty(const nodeindextype nodes) {
+    offsets.assign(nodes + 1, 0);
+    targets.clear();
+    targets.shrink_to_fit();
+    count = nodes;
+    own();
+} // empty
+
+
+// read the lists from external arrays that outlive this object
+void Adjacency::view(const nodeindextype nodes, const edgeindextype * offsetArray, const nodeindextype * targetArray) {
+    offsets.clear();
+    offsets.shrink_to_fit();
+    targets.clear();
+    targets.shrink_to_fit();
+    count = nodes;
+    own();
+    offsetData = offsetArray;
+    targetData = targetArray;
+} // view
+
+
+// number of distinct elements in the union of two sorted lists without duplicates
+static nodeindextype unionSize(const NodeSpan & a, const NodeSpan & b) {
+    NodeSpan::iterator p = a.begin(), q = b.begin();
+    const NodeSpan::iterator aEnd = a.end(), bEnd = b.end();
+    nodeindextype size = 0;
+    while(p != aEnd && q != bEnd) {
+        if(*p < *q)
+            ++p;
+        else if(*q < *p)
+            ++q;
+        else {
+            ++p;
+            ++q;
+        }
+        size++;
+    }
+    for(; p != aEnd; ++p)
+        size++;
+    for(; q != bEnd; ++q)
+        size++;
+    return size;
+} // unionSize
+
+
+// replace each list by its union with the same list in other, such as the
+// reverse lists to make a graph undirected; all lists must be sorted and
+// without duplicates, which the result then is as well (and not compressed)
+void Adjacency::unite(const Adjacency & other) {
+    vector<edgeindextype> unitedOffsets(count + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++)
+        unitedOffsets[i + 1] = unionSize((*this)[i], other[i]);
+    long long total = 0;
+    for(nodeindextype i = 0; i < count; i++)
+        total += unitedOffsets[i + 1];
+    if(total > numeric_limits<edgeindextype>::max())
+        throw overflow_error("too many edges for " + to_string(8 * sizeof(edgeindextype)) + "-bit list positions");
+    for(nodeindextype i = 0; i < count; i++)
+        unitedOffsets[i + 1] += unitedOffsets[i];
+
+    vector<nodeindextype> unitedTargets(unitedOffsets[count]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++) {
+        const NodeSpan a = (*this)[i], b = other[i];
+        set_union(a.begin(), a.end(), b.begin(), b.end(), unitedTargets.begin() + unitedOffsets[i]);
+    }
+
+    offsets.swap(unitedOffsets);
+    targets.swap(unitedTargets);
+    own();
+} // unite
+
+
+// merge the sorted list old without the entries of removed with the entries
+// of added, calling emit(j) for the resulting list in order
+template <typename Emit>
+static void updateList(const NodeSpan & old, const NodeSpan & added, const NodeSpan & removed, Emit emit) {
+    NodeSpan::iterator a = old.begin(), b = added.begin(), r = removed.begin();
+    const NodeSpan::iterator aEnd = old.end(), bEnd = added.end(), rEnd = removed.end();
+    while(a != aEnd || b != bEnd) {
+        if(b == bEnd || (a != aEnd && *a < *b)) {
+            const nodeindextype j = *a;
+            ++a;
+            while(r != rEnd && *r < j)
+                ++r;
+            if(r == rEnd || *r != j)
+                emit(j);
+        } else {
+            if(a != aEnd && *a == *b)
+                ++a;
+            emit(*b);
+            ++b;
+        }
+    }
+} // updateList
+
+
+// make these the lists of nodes nodes, where list i is the sorted list i of
+// base without the entries of removed[i], joined with the entries of added[i].
+// base may be this object itself; otherwise it is only read, so that an
+// updated graph can be built next to the one it is based on. all lists must be
+// sorted and unique, and remain so. the lists are compressed if those of base
+// are
+void Adjacency::update(const Adjacency & base, const nodeindextype nodes, const Adjacency & added,
+        const Adjacency & removed) {
+    const bool wasCompressed = base.compressed;
+    const auto list = [&](const nodeindextype i) { return i < base.count ? base[i] : NodeSpan(); };
+
+    vector<edgeindextype> updatedOffsets(nodes + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < nodes; i++) {
+        edgeindextype size = 0;
+        updateList(list(i), added[i], removed[i], [&](const nodeindextype) { size++; });
+        updatedOffsets[i + 1] = size;
+    }
+    long long total = 0;
+    for(nodeindextype i = 0; i < nodes; i++)
+        total += updatedOffsets[i + 1];
+    if(total > numeric_limits<edgeindextype>::max())
+        throw overflow_error("too many edges for " + to_string(8 * sizeof(edgeindextype)) + "-bit list positions");
+    for(nodeindextype i = 0; i < nodes; i++)
+        updatedOffsets[i + 1] += updatedOffsets[i];
+
+    vector<nodeindextype> updatedTargets(updatedOffsets[nodes]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < nodes; i++) {
+        edgeindextype k = updatedOffsets[i];
+        updateList(list(i), added[i], removed[i], [&](const nodeindextype j) { updatedTargets[k++] = j; });
+    }
+
+    offsets.swap(updatedOffsets);
+    targets.swap(updatedTargets);
+    count = nodes;
+    own();
+    if(wasCompressed)
+        compress();
+} // update
+
+
+// renumber the nodes: node i becomes node newId[i], both as the owner of a
+// list and as a neighbor. the renumbered lists are sorted again and are
+// compressed if they were before
+void Adjacency::permute(const vector<nodeindextype> & newId) {
+    const bool wasCompressed = compressed;
+    vector<nodeindextype> oldId(count);
+    for(nodeindextype i = 0; i < count; i++)
+        oldId[newId[i]] = i;
+
+    vector<edgeindextype> permutedOffsets(count + 1, 0);
+    for(nodeindextype i = 0; i < count; i++)
+        permutedOffsets[i + 1] = permutedOffsets[i] + degree(oldId[i]);
+
+    vector<nodeindextype> permutedTargets(permutedOffsets[count]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++) {
+        edgeindextype k = permutedOffsets[i];
+        forEach(oldId[i], [&](const nodeindextype j) {
+            permutedTargets[k++] = newId[j];
+        });
+        sort(permutedTargets.begin() + permutedOffsets[i], permutedTargets.begin() + permutedOffsets[i + 1]);
+    }
+
+    offsets.swap(permutedOffsets);
+    targets.swap(permutedTargets);
+    own();
+    if(wasCompressed)
+        compress();
+} // permute
+
+
+// sort each list and remove duplicates in parallel; returns the number of removed entries
+edgeindextype Adjacency::sortUnique() {
+    if(compressed) // compressed lists are sorted and unique already
+        return 0;
+    if(offsetData != offsets.data()) { // a view is read-only, so copy it first
+        offsets.assign(offsetData, offsetData + count + 1);
+        targets.assign(targetData, targetData + offsetData[count]);
+        own();
+    }
+
+    // sort and deduplicate each list where it is
+    vector<edgeindextype> packed(count + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++) {
+        const vector<nodeindextype>::iterator begin = targets.begin() + offsets[i];
+        const vector<nodeindextype>::iterator end = targets.begin() + offsets[i + 1];
+        sort(begin, end);
+        packed[i + 1] = unique(begin, end) - begin;
+    }
+    for(nodeindextype i = 0; i < count; i++)
+        packed[i + 1] += packed[i];
+
+    // then pack the lists together, if anything was removed
+    const edgeindextype removed = offsets[count] - packed[count];
+    if(removed > 0) {
+        vector<nodeindextype> packedTargets(packed[count]);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for(nodeindextype i = 0; i < count; i++)
+            copy(targets.begin() + offsets[i], targets.begin() + offsets[i] + (packed[i + 1] - packed[i]),
+                    packedTargets.begin() + packed[i]);
+        targets.swap(packedTargets);
+    }
+    offsets.swap(packed);
+    own();
+    return removed;
+} // sortUnique
+
+
+// bytes needed to store a value as varint
+static int varintSize(unsignednodeindextype value) {
+    int size = 1;
+    while(value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+} // varintSize
+
+
+// store a value as varint at p and return the position after it
+static unsigned char * writeVarint(unsigned char * p, unsignednodeindextype value) {
+    while(value >= 0x80) {
+        *p++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (unsigned char) value;
+    return p;
+} // writeVarint
+
+
+// the varints of list i: its size, the zigzag-encoded difference between the
+// first neighbor and i, and the gaps between consecutive neighbors minus one;
+// with out set to nullptr only the number of bytes is computed
+static long encodeList(const NodeSpan & list, const nodeindextype i, unsigned char * out) {
+    const unsignednodeindextype count = list.size();
+    long size = varintSize(count);
+    nodeindextype previous = 0;
+    bool first = true;
+    if(out)
+        out = writeVarint(out, count);
+    for(const nodeindextype j : list) {
+        const nodeindextype diff = j - i;
+        const unsignednodeindextype value = first ?
+                ((unsignednodeindextype) diff << 1) ^ (unsignednodeindextype)(diff >> (8 * sizeof(diff) - 1)) :
+                (unsignednodeindextype)(j - previous - 1);
+        size += varintSize(value);
+        if(out)
+            out = writeVarint(out, value);
+        previous = j;
+        first = false;
+    }
+    return size;
+} // encodeList
+
+
+// store the lists as varints, which takes a fraction of the memory of plain
+// lists; the lists must be sorted and without duplicates
+void Adjacency::compress() {
+    if(compressed)
+        return;
+    vector<long> encodedOffsets(count + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++)
+        encodedOffsets[i + 1] = encodeList((*this)[i], i, nullptr);
+    for(nodeindextype i = 0; i < count; i++)
+        encodedOffsets[i + 1] += encodedOffsets[i];
+
+    vector<unsigned char> encoded(encodedOffsets[count]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++)
+        encodeList((*this)[i], i, encoded.data() + encodedOffsets[i]);
+
+    const edgeindextype total = edges();
+    offsets.clear();
+    offsets.shrink_to_fit();
+    targets.clear();
+    targets.shrink_to_fit();
+    offsetData = nullptr;
+    targetData = nullptr;
+    byteOffsets.swap(encodedOffsets);
+    bytes.swap(encoded);
+    edgeCount = total;
+    compressed = true;
+} // compress
+
+
+// back to plain lists
+void Adjacency::decompress() {
+    if(!compressed)
+        return;
+    vector<edgeindextype> plainOffsets(count + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++)
+        plainOffsets[i + 1] = degree(i);
+    for(nodeindextype i = 0; i < count; i++)
+        plainOffsets[i + 1] += plainOffsets[i];
+
+    vector<nodeindextype> plainTargets(plainOffsets[count]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < count; i++) {
+        const NodeSpan list = (*this)[i];
+        copy(list.begin(), list.end(), plainTargets.begin() + plainOffsets[i]);
+    }
+
+    offsets.swap(plainOffsets);
+    targets.swap(plainTargets);
+    own();
+} // decompress
+
+
+// memory used by the lists, whether owned or not
+size_t Adjacency::memoryBytes() const {
+    if(compressed)
+        return byteOffsets.size() * sizeof(long) + bytes.size();
+    return (count + 1) * sizeof(edgeindextype) + edges() * sizeof(nodeindextype);
+} // memoryBytes
+
+
+// point at the owned plain storage
+void Adjacency::own() {
+    offsetData = offsets.data();
+    targetData = targets.data();
+    compressed = false;
+    byteOffsets.clear();
+    byteOffsets.shrink_to_fit();
+    bytes.clear();
+    bytes.shrink_to_fit();
+    edgeCount = 0;
+} // own
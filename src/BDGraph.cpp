@@ -12,48 +12,57 @@
  * F.W. Takes and W.A. Kosters, Computing the Eccentricity Distribution of Large Graphs,
  * Algorithms 6(1): 100-118, 2013. http://dx.doi.org/10.3390/a6010100
  *
+ * Each round of BoundingDiameters computes the eccentricities of as many
+ * selected nodes as there are CPUs, with concurrent BFSs, and then merges the
+ * bounds they give. The bounds only depend on which eccentricities are known,
+ * so the result is exact for any number of CPUs; with a single CPU, the nodes
+ * are selected one at a time exactly as in the papers above.
  */
 
 #include <teexgraph/Graph.h>
 
-#include <queue>
+#include "Workspace.h"
+
+#include <algorithm>
 #include <string>
 #include <vector>
 
 using namespace std;
 using namespace teexgraph;
 
+namespace {
+
+// raise x to at least value, also when other threads do the same
+void atomicMax(nodeindextype & x, const nodeindextype value) {
+    nodeindextype current = __atomic_load_n(&x, __ATOMIC_RELAXED);
+    while(value > current && !__atomic_compare_exchange_n(&x, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+} // atomicMax
+
+// lower x to at most value, also when other threads do the same
+void atomicMin(nodeindextype & x, const nodeindextype value) {
+    nodeindextype current = __atomic_load_n(&x, __ATOMIC_RELAXED);
+    while(value < current && !__atomic_compare_exchange_n(&x, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+} // atomicMin
+
+} // namespace
+
 // compute the eccentricity of node u - O(m)
-int Graph::eccentricity(const int u) {
-    int current, z, ecc = 0;
-    queue<int> q;
-    d.assign(nodes(Scope::FULL), -1);
-
-    d[u] = 0;
-    q.push(u);
-    while(!q.empty()) {
-        current = q.front();
-        q.pop();
-        z = neighbors(current).size();
-        for(int j = 0; j < z; j++) {
-            if(d[neighbors(current)[j]] == -1 && pruned[neighbors(current)[j]] < 0) {
-                d[neighbors(current)[j]] = d[current] + 1;
-                q.push(neighbors(current)[j]);
-                ecc = max(ecc, d[neighbors(current)[j]]);
-            }
-        }
-    }
+nodeindextype Graph::eccentricity(const nodeindextype u) {
+    if(scanner)
+        return eccentricityExternal(u);
+    const nodeindextype ecc = bfs(u, &pruned).size() - 1;
+    Workspace::local().distances(d);
     return ecc;
 } // eccentricity
 
 
 // compute the diameter of the WCC, brute-force (APSP) - O(mn)
-int Graph::diameterAPSP() {
+nodeindextype Graph::diameterAPSP() {
     pruned.assign(nodes(Scope::FULL), -1);
     computeWCC();
-    int diameter = 0;
+    nodeindextype diameter = 0;
     cerr << "Computing graph diameter using APSP..." << endl;
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         if(i % (nodes(Scope::FULL) / 100) == 0) // show status %
             cerr << "\b\b\b\b" << i / (nodes(Scope::FULL) / 100) << "%";
         if(inScope(i, Scope::LWCC))
@@ -65,12 +74,12 @@ int Graph::diameterAPSP() {
 
 
 // compute the radius of the WCC, brute-force (APSP) - O(mn)
-int Graph::radiusAPSP() {
+nodeindextype Graph::radiusAPSP() {
     pruned.assign(nodes(Scope::FULL), -1);
     computeWCC();
-    int rad = nodes(Scope::FULL);
+    nodeindextype rad = nodes(Scope::FULL);
     cerr << "Computing graph radius using APSP..." << endl;
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         if(i % (nodes(Scope::FULL) / 100) == 0) // show status %
             cerr << "\b\b\b\b" << i / (nodes(Scope::FULL) / 100) << "%";
         if(inScope(i, Scope::LWCC))
@@ -82,24 +91,23 @@ int Graph::radiusAPSP() {
 
 
 // pruning strategy
-int Graph::pruning() {
-    int z, count = 0, prunee = -1;
+nodeindextype Graph::pruning() {
+    nodeindextype count = 0, prunee = -1;
     pruned.assign(nodes(Scope::FULL), -1);
 
     // pruned[i] is going to contain the node number that i has identical ecc to
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         if(!inScope(i, Scope::LWCC))
             continue;
 
-        z = neighbors(i).size();
         prunee = -1;
 
-        for(int j = 0; j < z; j++) {
-            if(neighbors(neighbors(i)[j]).size() == 1 && pruned[neighbors(i)[j]] == -1) {
+        for(const nodeindextype j : neighbors(i)) {
+            if(E.degree(j) == 1 && pruned[j] == -1) {
                 if(prunee == -1) { // prune all but this one
-                    prunee = neighbors(i)[j];
+                    prunee = j;
                 } else {
-                    pruned[neighbors(i)[j]] = prunee; // [0...n-1] indicates that the node was pruned as it is identical to prunee
+                    pruned[j] = prunee; // [0...n-1] indicates that the node was pruned as it is identical to prunee
                     count++;
                     pruned[prunee] = -2; // -2 indicates that its neighbors have been pruned
                 }
@@ -113,21 +121,21 @@ int Graph::pruning() {
 
 
 // compute the graph's WCC diameter using BoundingDiameters
-int Graph::diameterBD() {
+nodeindextype Graph::diameterBD() {
     const bool PRUNE = true;
     return extremaBounding(Extremum::DIAMETER, PRUNE);
 } // diameterBD
 
 
 // compute the graph's WCC radius using BoundingDiameters
-int Graph::radiusBD() {
+nodeindextype Graph::radiusBD() {
     const bool PRUNE = true;
     return extremaBounding(Extremum::RADIUS, PRUNE);
 } // radiusBD
 
 
 // get the eccentricities of each of the nodes in the WCC of the graph
-vector<int> Graph::eccentricitiesBD() {
+vector<nodeindextype> Graph::eccentricitiesBD() {
     const bool PRUNE = true;
     extremaBounding(Extremum::ECCENTRICITIES, PRUNE);
     return ecc_lower;
@@ -135,31 +143,31 @@ vector<int> Graph::eccentricitiesBD() {
 
 
 // get the eccentricities of each of the nodes in the WCC of the graph brute force
-vector<int> Graph::eccentricitiesAPSP() {
+vector<nodeindextype> Graph::eccentricitiesAPSP() {
     pruned.assign(nodes(Scope::FULL), -1);
-    vector<int> intarray(nodes(Scope::FULL), 0);
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    vector<nodeindextype> intarray(nodes(Scope::FULL), 0);
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         intarray[i] = eccentricity(i);
     }
     return intarray;
 } // eccentricitiesAPSP
 
 // compute the graph's WCC's periphery using BoundingDiameters
-int Graph::peripherySizeBD() {
+nodeindextype Graph::peripherySizeBD() {
     const bool PRUNE = true;
     return extremaBounding(Extremum::PERIPHERY_SIZE, PRUNE);
 } // peripheryBD
 
 
 // compute the graph's WCC's center using BoundingDiameters
-int Graph::centerSizeBD() {
+nodeindextype Graph::centerSizeBD() {
     const bool PRUNE = true;
     return extremaBounding(Extremum::CENTER_SIZE, PRUNE);
 } // centerBD
 
 
 // compute extreme distance values in the WCC using BoundingDiameters
-int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE = false) {
+nodeindextype Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE = false) {
 
     if(!isUndirected() || nodes(Scope::LWCC) < 2) {
         cerr << "BoundingDiameters is only implemented for undirected graphs' scope LWCC." << endl;
@@ -168,9 +176,9 @@ int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE
     }
 
     // initialize some values
-    int it = 0, current_ecc, current = -1, // n-1 for random
-            minupper = -2, maxupper = -1, minlower = -4, maxlower = -3,
-            minlowernode = -1, maxuppernode = -1,
+    int it = 0;
+    long bfss = 0; // eccentricities computed
+    nodeindextype minupper = -2, maxupper = -1, minlower = -4, maxlower = -3,
             candidates = nodes(Scope::LWCC);
     bool showstatus = false;
     ecc_lower.assign(nodes(Scope::FULL), 0);
@@ -178,6 +186,11 @@ int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE
     candidate.assign(nodes(Scope::FULL), true);
     d.assign(nodes(Scope::FULL), 0);
 
+    // the nodes investigated in a round, one per CPU; in semi-external mode
+    // one at a time, as each BFS streams the lists from disk
+    const size_t batchsize = scanner ? 1 : omp_get_max_threads();
+    vector<nodeindextype> batch, eccs, remaining;
+
     // initialize high/low selection bool
     bool high = true;
 
@@ -186,67 +199,104 @@ int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE
     if(PRUNE)
         candidates -= pruning();
 
+    // the nodes that are not pruned, and the candidates among them
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++)
+        if(inScope(i, Scope::LWCC) && pruned[i] < 0)
+            remaining.push_back(i);
+    const vector<nodeindextype> unpruned(remaining);
+    const auto highestDegree = [&](const nodeindextype a, const nodeindextype b) {
+        return E.degree(a) > E.degree(b) || (E.degree(a) == E.degree(b) && a < b);
+    };
+    const auto highestUpper = [&](const nodeindextype a, const nodeindextype b) {
+        return ecc_upper[a] > ecc_upper[b] || (ecc_upper[a] == ecc_upper[b] && highestDegree(a, b));
+    };
+    const auto lowestLower = [&](const nodeindextype a, const nodeindextype b) {
+        return ecc_lower[a] < ecc_lower[b] || (ecc_lower[a] == ecc_lower[b] && highestDegree(a, b));
+    };
+
 
     // start the main loop
     while(candidates > 0) {
         ++it;
 
-        // select a random node (much slower, may serve as baseline)
-        /*
-        do {
-                current = rand() % n;
-        } while(!candidate[current] || !inScope(current, Scope::LWCC) || pruned[current] >= 0);
-         */
-
-        // select the next node to be investigated
-        //selectFrom(); // this function has been unrolled here
+        // select the nodes to be investigated: in the first round the nodes
+        // with highest degree, then alternately those with the highest upper
+        // bound and the lowest lower bound. nodes next to an already selected
+        // node have nearly the same eccentricity, so they are only taken if
+        // there are not enough other nodes
         high = !high;
-        if(current == -1) { // only in the first round, select node with highest degree
-            current = 0;
-            for(int i = 1; i < nodes(Scope::FULL); i++) {
-                if(d[i] == -1 || !inScope(i, Scope::LWCC) || pruned[i] >= 0)
-                    continue;
-                if(neighbors(i).size() > neighbors(current).size()) {
-                    current = i;
+        vector<nodeindextype> byUpper, byLower;
+        const size_t options = min(remaining.size(), 4 * batchsize);
+        for(vector<nodeindextype> * list : {&byUpper, &byLower}) {
+            *list = remaining;
+            const bool first = (it == 1), upper = (list == &byUpper);
+            partial_sort(list->begin(), list->begin() + options, list->end(), [&](const nodeindextype a, const nodeindextype b) {
+                return first ? highestDegree(a, b) : upper ? highestUpper(a, b) : lowestLower(a, b);
+            });
+            list->resize(options);
+        }
+        batch.clear();
+        for(int pass = 0; pass < 2 && batch.size() < min(batchsize, remaining.size()); pass++)
+            for(size_t k = 0; k < 2 * options && batch.size() < min(batchsize, remaining.size()); k++) {
+                const nodeindextype u = ((k % 2 == 0) == high) ? byUpper[k / 2] : byLower[k / 2];
+                bool taken = false, close = false;
+                for(const nodeindextype v : batch) {
+                    taken = taken || v == u;
+                    close = close || edge(v, u);
                 }
-            } // for
-        }// if
-        else if(high) // select node with highest upper bound
-            current = maxuppernode;
-        else // select node with lowest lower bound
-            current = minlowernode;
-
-        // determine the eccentricity of the current node
-        current_ecc = eccentricity(current);
+                if(!taken && (pass == 1 || !close))
+                    batch.push_back(u);
+            }
 
         // output some status info (1)
         if(TYPE != Extremum::ECCENTRICITIES || candidates % (1 + (nodes(Scope::LWCC) / 100)) == 0) {
             cerr << setw(3) << it
-                    << ". Current: " << setw(8) << revMapNode(current)
-                    << " (" << ecc_lower[current] << "/"
-                    << ecc_upper[current] << ") -> ";
+                    << ". Current: " << setw(8) << nodeName(batch[0])
+                    << " (" << ecc_lower[batch[0]] << "/"
+                    << ecc_upper[batch[0]] << ")";
+            if(batch.size() > 1)
+                cerr << " and " << batch.size() - 1 << " more";
+            cerr << " -> ";
             showstatus = true;
         }
 
-        // initialize min/max values
-        maxuppernode = -1;
-        minlowernode = -1;
+        // determine the eccentricities of the selected nodes and narrow the
+        // bounds of every node they reach; in parallel, one BFS per CPU
+        eccs.assign(batch.size(), 0);
+        if(scanner) {
+            eccs[0] = eccentricity(batch[0]);
+            for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
+                if(d[i] == -1 || !inScope(i, Scope::LWCC) || pruned[i] >= 0)
+                    continue;
+                ecc_lower[i] = max(ecc_lower[i], max(d[i], eccs[0] - d[i]));
+                ecc_upper[i] = min(ecc_upper[i], eccs[0] + d[i]);
+            }
+        } else {
+#pragma omp parallel for schedule(dynamic, 1) if(batch.size() > 1)
+            for(size_t j = 0; j < batch.size(); j++) {
+                eccs[j] = bfs(batch[j], &pruned).size() - 1;
+                const Workspace & ws = Workspace::local();
+                for(const nodeindextype i : ws.order) {
+                    if(!inScope(i, Scope::LWCC) || pruned[i] >= 0)
+                        continue;
+                    const nodeindextype di = ws.distance(i);
+                    atomicMax(ecc_lower[i], max(di, eccs[j] - di));
+                    atomicMin(ecc_upper[i], eccs[j] + di);
+                }
+            }
+        }
+        bfss += batch.size();
+
 		// initialize min/max values
 		minlower = nodes(Scope::LWCC);
 		maxlower = 0;
 		minupper = nodes(Scope::LWCC);
 		maxupper = 0;
 
-        // update bounds
-        for(int i = 0; i < nodes(Scope::FULL); i++) {
-            if(d[i] == -1 || !inScope(i, Scope::LWCC) || pruned[i] >= 0)
-                continue;
-
-            // update eccentricity bounds
-            ecc_lower[i] = max(ecc_lower[i], max(d[i], current_ecc - d[i]));
-            ecc_upper[i] = min(ecc_upper[i], current_ecc + d[i]);
-
-            // update min/max values of lower and upper bounds
+        // update min/max values of lower and upper bounds
+#pragma omp parallel for schedule(static) reduction(min:minlower, minupper) reduction(max:maxlower, maxupper)
+        for(size_t k = 0; k < unpruned.size(); k++) {
+            const nodeindextype i = unpruned[k];
             minlower = min(ecc_lower[i], minlower);
             minupper = min(ecc_upper[i], minupper);
             maxlower = max(ecc_lower[i], maxlower);
@@ -254,10 +304,8 @@ int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE
         }
 
         // update candidate set
-        for(int i = 0; i < nodes(Scope::FULL); i++) {
-            if(!candidate[i] || d[i] == -1 || !inScope(i, Scope::LWCC) || pruned[i] >= 0)
-                continue;
-
+        size_t kept = 0;
+        for(const nodeindextype i : remaining) {
             // disregard nodes that can no longer contribute
             if(candidate[i] && (
                     (ecc_lower[i] == ecc_upper[i]) || (
@@ -270,40 +318,26 @@ int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE
                 candidate[i] = false;
                 candidates--;
             }
-
-            // updating maxuppernode and minlowernode for selection in next round
-            if(candidate[i]) {
-                if(minlowernode == -1)
-                    minlowernode = i;
-                else if(ecc_lower[i] == ecc_lower[minlowernode] && neighbors(i).size() > neighbors(minlowernode).size())
-                    minlowernode = i;
-                else if(ecc_lower[i] < ecc_lower[minlowernode])
-                    minlowernode = i;
-                if(maxuppernode == -1)
-                    maxuppernode = i;
-                else if(ecc_upper[i] == ecc_upper[maxuppernode] && neighbors(i).size() > neighbors(maxuppernode).size())
-                    maxuppernode = i;
-                else if(ecc_upper[i] > ecc_upper[maxuppernode])
-                    maxuppernode = i;
-            }
+            if(candidate[i])
+                remaining[kept++] = i;
         }
+        remaining.resize(kept);
 
         // output some status info (2)
         if(TYPE != Extremum::ECCENTRICITIES || showstatus) {
-            cerr << setw(3) << current_ecc << " - Bounds: min="
+            cerr << setw(3) << *max_element(eccs.begin(), eccs.end()) << " - Bounds: min="
                     << minlower << "/" << minupper << " max=" << maxlower << "/" << maxupper
                     << " - Candidates: " << candidates << endl;
             showstatus = false;
         }
-        // current = -1; // do this to re-select a high degree node in the next iteration
     }
 
     // display number of iterations
     cerr << "\nIterations: ";
     //cout << "\t" << it;
-    cerr << "\t" << it;
+    cerr << "\t" << it << " (" << bfss << " eccentricities)";
     cerr << endl << "Number of brute-force iterations: " << nodes(Scope::LWCC)
-            << ". Speed-up factor: " << (double) nodes(Scope::LWCC) / it << endl;
+            << ". Speed-up factor: " << (double) nodes(Scope::LWCC) / bfss << endl;
 
     // return the diameter
     if(TYPE == Extremum::DIAMETER) {
@@ -319,15 +353,15 @@ int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE
 
     // process ecc values for pruned nodes
     if(PRUNE) {
-        for(int i = 0; i < nodes(Scope::FULL); i++)
+        for(nodeindextype i = 0; i < nodes(Scope::FULL); i++)
             if(pruned[i] >= 0)
-                ecc_lower[i] = ecc_lower[(int) pruned[i]];
+                ecc_lower[i] = ecc_lower[pruned[i]];
     }
 
     // return the periphery size
     if(TYPE == Extremum::PERIPHERY_SIZE) {
-        int periphery = 0;
-        for(int i = 0; i < nodes(Scope::FULL); i++) {
+        nodeindextype periphery = 0;
+        for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
             if(ecc_lower[i] == maxlower)
                 periphery++;
         }
@@ -337,8 +371,8 @@ int Graph::extremaBounding(Extremum TYPE = Extremum::DIAMETER, const bool PRUNE
 
     // return the center size
     if(TYPE == Extremum::CENTER_SIZE) {
-        int center = 0;
-        for(int i = 0; i < nodes(Scope::FULL); i++) {
+        nodeindextype center = 0;
+        for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
             if(ecc_upper[i] == minupper)
                 center++;
         }
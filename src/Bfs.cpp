@@ -0,0 +1,383 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Direction-optimizing breadth-first search, shared by the single-source
+ * distance functions. See the following paper for details:
+ *
+ * S. Beamer, K. Asanovic and D. Patterson, Direction-Optimizing Breadth-First
+ * Search, in Proceedings of the International Conference on High Performance
+ * Computing, Networking, Storage and Analysis (SC 2012), pp. 1-10, 2012.
+ * http://dx.doi.org/10.1109/SC.2012.50
+ *
+ * A top-down step expands the nodes of the current level along their out-lists.
+ * Once the current level holds a large part of the edges that have not been
+ * explored, a bottom-up step is cheaper: every unvisited node looks for a
+ * parent on the current level in its in-list, which is kept as a bitmap, and
+ * stops at the first one found. Both steps are parallel within the level; when
+ * called from a parallel loop over sources, they run on the calling thread.
+ * Functions that need a BFS from many sources instead run 64 of them at once.
+ * Both use the workspace of the calling thread (see Workspace.h).
+ */
+
+#include <teexgraph/Graph.h>
+
+#include "Workspace.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace teexgraph;
+
+namespace {
+
+const long TOP_DOWN_FACTOR = 14; // go bottom-up once the level has 1/14 of the unexplored edges
+const long BOTTOM_UP_FACTOR = 24; // and back when the level has less than 1/24 of the nodes
+const size_t PARALLEL_LEVEL = 4096; // smaller levels are expanded on a single thread
+const long SWEEP_FACTOR = 16; // multi-source BFS: scan all nodes once the frontier has 1/16 of them
+
+
+// visit the unvisited out-neighbors of the nodes in [frontier, frontier + size)
+// at distance level + 1, adding them to ws.next. a node is visited by the
+// thread that claims it first
+template <typename Allowed>
+void topDownStep(const Adjacency & out, Workspace & ws, const nodeindextype * frontier, const size_t size,
+        const nodeindextype level, Allowed allowed) {
+#pragma omp parallel if(size > PARALLEL_LEVEL)
+    {
+        vector<nodeindextype> found;
+#pragma omp for schedule(dynamic, 256) nowait
+        for(size_t i = 0; i < size; i++)
+            out.forEach(frontier[i], [&](const nodeindextype w) {
+                if(!ws.visited(w) && allowed(w) && ws.claim(w, level + 1))
+                    found.push_back(w);
+            });
+#pragma omp critical
+        ws.next.insert(ws.next.end(), found.begin(), found.end());
+    }
+} // topDownStep
+
+
+// visit every unvisited node with an in-neighbor in [frontier, frontier + size)
+// at distance level + 1, adding them to ws.next. each node is only visited by
+// the thread that checks it
+template <typename Allowed>
+void bottomUpStep(const Adjacency & in, Workspace & ws, const nodeindextype * frontier, const size_t size,
+        const nodeindextype n, const nodeindextype level, Allowed allowed) {
+    ws.bitmap.assign((n + 63) / 64, 0);
+#pragma omp parallel for schedule(static) if(size > PARALLEL_LEVEL)
+    for(size_t i = 0; i < size; i++)
+        __atomic_fetch_or(&ws.bitmap[frontier[i] >> 6], uint64_t(1) << (frontier[i] & 63), __ATOMIC_RELAXED);
+
+#pragma omp parallel if((size_t) n > PARALLEL_LEVEL)
+    {
+        vector<nodeindextype> found;
+#pragma omp for schedule(dynamic, 1024) nowait
+        for(nodeindextype v = 0; v < n; v++) {
+            if(ws.visited(v) || !allowed(v))
+                continue;
+            for(const nodeindextype w : in[v])
+                if((ws.bitmap[w >> 6] >> (w & 63)) & 1) {
+                    ws.visit(v, level + 1);
+                    found.push_back(v);
+                    break;
+                }
+        }
+#pragma omp critical
+        ws.next.insert(ws.next.end(), found.begin(), found.end());
+    }
+} // bottomUpStep
+
+} // namespace
+
+
+// breadth-first search from u in the workspace of the calling thread, which
+// afterwards holds the distance from u of every node and the reached nodes in
+// order of distance. nodes w with (*skip)[w] >= 0 are not entered. with
+// reverse set, the search follows edges backward, giving distances to u. the
+// search stops at the level where all nodes in *until are reached, if given.
+// returns the number of nodes at each distance from u
+vector<nodeindextype> Graph::bfs(const nodeindextype u, const vector<nodeindextype> * skip, const bool reverse,
+        const vector<nodeindextype> * until) const {
+    Workspace & ws = Workspace::local();
+    const Adjacency & out = reverse ? (undirected ? E : rE) : E;
+    const Adjacency & in = reverse ? E : (undirected ? E : rE);
+    const auto allowed = [skip](const nodeindextype w) { return skip == nullptr || (*skip)[w] < 0; };
+    vector<nodeindextype> levels;
+    long unexplored = m;
+    bool bottomUp = false;
+
+    ws.start(n);
+    ws.visit(u, 0);
+    ws.order.push_back(u);
+    for(size_t begin = 0, end = 1; begin < end; begin = end, end = ws.order.size()) {
+        const nodeindextype level = levels.size();
+        levels.push_back(end - begin);
+        if(until != nullptr && all_of(until->begin(), until->end(),
+                [&](const nodeindextype w) { return ws.visited(w); }))
+            break;
+
+        const nodeindextype * frontier = ws.order.data() + begin;
+        const size_t size = end - begin;
+        long frontierEdges = 0;
+#pragma omp parallel for reduction(+:frontierEdges) schedule(static) if(size > PARALLEL_LEVEL)
+        for(size_t i = 0; i < size; i++)
+            frontierEdges += out.degree(frontier[i]);
+        unexplored -= frontierEdges;
+        if(!bottomUp && frontierEdges > unexplored / TOP_DOWN_FACTOR)
+            bottomUp = true;
+        else if(bottomUp && (long) size < n / BOTTOM_UP_FACTOR)
+            bottomUp = false;
+
+        ws.next.clear();
+        if(bottomUp)
+            bottomUpStep(in, ws, frontier, size, n, level, allowed);
+        else
+            topDownStep(out, ws, frontier, size, level, allowed);
+        ws.order.insert(ws.order.end(), ws.next.begin(), ws.next.end());
+    }
+    return levels;
+} // bfs
+
+
+// breadth-first search from count <= 64 sources at once, with one bit per
+// source in a word per node, so that all searches share every scan of an
+// out-list (see Then et al., The More the Merrier: Efficient Multi-Source
+// Graph Traversal, PVLDB 8(4), 2014). adds the number of (source, node) pairs
+// at each distance to *counts, and the sum of the distances from the sources
+// to each node w to (*sums)[w], for whichever of the two is given
+void Graph::multiBfs(const nodeindextype * sources, const int count, vector<long> * counts,
+        vector<long> * sums) const {
+    Workspace & ws = Workspace::local();
+    vector<uint64_t> & visited = ws.seen, & frontier = ws.current, & next = ws.reached;
+    vector<nodeindextype> & frontierNodes = ws.list, & touched = ws.next;
+    visited.assign(n, 0);
+    frontier.assign(n, 0);
+    next.assign(n, 0);
+    frontierNodes.clear();
+    for(int k = 0; k < count; k++) {
+        if(frontier[sources[k]] == 0)
+            frontierNodes.push_back(sources[k]);
+        visited[sources[k]] |= uint64_t(1) << k;
+        frontier[sources[k]] |= uint64_t(1) << k;
+    }
+    if(counts != nullptr)
+        (*counts)[0] += count;
+
+    for(nodeindextype level = 1; !frontierNodes.empty(); level++) {
+        // the searches that reach node w for the first time at this level
+        const auto reach = [&](const nodeindextype w, const uint64_t reached) {
+            const long reachedCount = bitset<64>(reached).count();
+            visited[w] |= reached;
+            if(counts != nullptr)
+                (*counts)[level] += reachedCount;
+            if(sums != nullptr)
+                (*sums)[w] += level * reachedCount;
+        };
+
+        // a large frontier is expanded by scanning all nodes, a small one
+        // through the lists of frontier nodes and of nodes touched from them,
+        // so that a level costs O(n) only if its frontier is large
+        if((long) frontierNodes.size() > n / SWEEP_FACTOR) {
+            for(nodeindextype v = 0; v < n; v++) {
+                const uint64_t bits = frontier[v];
+                if(bits != 0)
+                    E.forEach(v, [&](const nodeindextype w) { next[w] |= bits; });
+            }
+            frontierNodes.clear();
+            for(nodeindextype w = 0; w < n; w++) {
+                const uint64_t reached = next[w] & ~visited[w];
+                frontier[w] = reached;
+                next[w] = 0;
+                if(reached != 0) {
+                    reach(w, reached);
+                    frontierNodes.push_back(w);
+                }
+            }
+        } else {
+            touched.clear();
+            for(const nodeindextype v : frontierNodes) {
+                const uint64_t bits = frontier[v];
+                E.forEach(v, [&](const nodeindextype w) {
+                    const uint64_t reached = bits & ~visited[w];
+                    if(reached != 0) {
+                        if(next[w] == 0)
+                            touched.push_back(w);
+                        next[w] |= reached;
+                    }
+                });
+            }
+            for(const nodeindextype v : frontierNodes)
+                frontier[v] = 0;
+            for(const nodeindextype w : touched) {
+                frontier[w] = next[w];
+                next[w] = 0;
+                reach(w, frontier[w]);
+            }
+            frontierNodes.swap(touched);
+        }
+    }
+} // multiBfs
+
+
+// distance from u to v by a breadth-first search from both ends, which each
+// round expands a full level of the side whose level has the fewest edges:
+// forward along out-lists from u, backward along in-lists from v. it stops at
+// the first level at which the two searches meet, so that its cost depends on
+// the part of the graph around u and v rather than on n. sets *path to a
+// shortest path from u to v if path is given, and adds the number of edges
+// scanned to *explored if that is given. returns -1 if there is no path
+nodeindextype Graph::bidirectionalBfs(const nodeindextype u, const nodeindextype v,
+        vector<nodeindextype> * path, long * explored) const {
+    Workspace & ws = Workspace::local();
+    const Adjacency & in = undirected ? E : rE;
+    // a node visited backward at distance x from v is stored as distance -2 - x
+    const auto backward = [&](const nodeindextype w) { return ws.visited(w) && ws.distance(w) < 0; };
+
+    ws.start(n);
+    ws.parents.resize(n);
+    ws.visit(u, 0);
+    ws.parents[u] = u;
+    vector<nodeindextype> & forwardLevel = ws.order, & backwardLevel = ws.list, & next = ws.next;
+    forwardLevel.assign(1, u);
+    backwardLevel.clear();
+    nodeindextype best = -1, meetFrom = -1, meetTo = -1; // shortest connection found
+    if(u == v)
+        best = 0;
+    else {
+        ws.visit(v, -2);
+        ws.parents[v] = v;
+        backwardLevel.push_back(v);
+    }
+
+    for(nodeindextype forwardDistance = 0, backwardDistance = 0;
+            best < 0 && !forwardLevel.empty() && !backwardLevel.empty(); ) {
+        long forwardEdges = 0, backwardEdges = 0;
+        for(const nodeindextype x : forwardLevel)
+            forwardEdges += E.degree(x);
+        for(const nodeindextype x : backwardLevel)
+            backwardEdges += in.degree(x);
+        const bool forward = forwardEdges <= backwardEdges;
+        if(explored != nullptr)
+            *explored += forward ? forwardEdges : backwardEdges;
+
+        next.clear();
+        for(const nodeindextype x : forward ? forwardLevel : backwardLevel)
+            (forward ? E : in).forEach(x, [&](const nodeindextype w) {
+                if(!ws.visited(w)) {
+                    ws.visit(w, forward ? forwardDistance + 1 : -3 - backwardDistance);
+                    ws.parents[w] = x;
+                    next.push_back(w);
+                } else if(forward == backward(w)) { // the searches meet on edge x-w
+                    const nodeindextype length = forward ? forwardDistance + 1 - 2 - ws.distance(w)
+                            : backwardDistance + 1 + ws.distance(w);
+                    if(best < 0 || length < best) {
+                        best = length;
+                        meetFrom = forward ? x : w;
+                        meetTo = forward ? w : x;
+                    }
+                }
+            });
+        if(forward) {
+            forwardLevel.swap(next);
+            forwardDistance++;
+        } else {
+            backwardLevel.swap(next);
+            backwardDistance++;
+        }
+    }
+
+    if(path != nullptr) {
+        path->clear();
+        if(best > 0) { // follow the parents from the edge meetFrom-meetTo to both ends
+            for(nodeindextype x = meetFrom; ; x = ws.parents[x]) {
+                path->push_back(x);
+                if(x == u)
+                    break;
+            }
+            reverse(path->begin(), path->end());
+            for(nodeindextype x = meetTo; ; x = ws.parents[x]) {
+                path->push_back(x);
+                if(x == v)
+                    break;
+            }
+        } else if(best == 0)
+            path->push_back(u);
+    }
+    return best;
+} // bidirectionalBfs
+
+
+// distance of every pair (u, v) in pairs, or -1 if v cannot be reached from u.
+// pairs are grouped by source, or by target if more pairs share their target.
+// the pairs of a group are answered one by one with bidirectionalBfs() until
+// that has scanned as many edges as a full search would, after which all
+// remaining pairs of the group are answered by a single search from the shared
+// node that stops once all their other ends are reached: forward from a
+// source, or backward from a target. this takes at most about twice as long as
+// the better of the two. groups are answered in parallel
+vector<nodeindextype> Graph::distances(const vector< pair<nodeindextype, nodeindextype> > & pairs) const {
+    const size_t count = pairs.size();
+    vector<nodeindextype> result(count, -1);
+    if(labels) { // queries to the distance index are independent
+#pragma omp parallel for schedule(dynamic, 1024)
+        for(size_t i = 0; i < count; i++)
+            result[i] = distance(pairs[i].first, pairs[i].second);
+        return result;
+    }
+
+    // the number of pairs with the same source and with the same target
+    vector<size_t> bySource(count), byTarget(count), sameSource(count), sameTarget(count);
+    iota(bySource.begin(), bySource.end(), 0);
+    iota(byTarget.begin(), byTarget.end(), 0);
+    sort(bySource.begin(), bySource.end(), [&](const size_t a, const size_t b) { return pairs[a].first < pairs[b].first; });
+    sort(byTarget.begin(), byTarget.end(), [&](const size_t a, const size_t b) { return pairs[a].second < pairs[b].second; });
+    for(size_t i = 0, j = 0; i < count; i = j) {
+        for(j = i; j < count && pairs[bySource[j]].first == pairs[bySource[i]].first; j++);
+        for(size_t k = i; k < j; k++)
+            sameSource[bySource[k]] = j - i;
+    }
+    for(size_t i = 0, j = 0; i < count; i = j) {
+        for(j = i; j < count && pairs[byTarget[j]].second == pairs[byTarget[i]].second; j++);
+        for(size_t k = i; k < j; k++)
+            sameTarget[byTarget[k]] = j - i;
+    }
+
+    // groups of pairs, as (backward, shared node) per pair
+    vector< pair<bool, nodeindextype> > key(count);
+    for(size_t i = 0; i < count; i++)
+        key[i] = (sameTarget[i] > sameSource[i]) ? make_pair(true, pairs[i].second) : make_pair(false, pairs[i].first);
+    vector<size_t> order(count);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return key[a] < key[b]; });
+    vector<size_t> groups;
+    for(size_t i = 0; i < count; i++)
+        if(i == 0 || key[order[i]] != key[order[i - 1]])
+            groups.push_back(i);
+    groups.push_back(count);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for(size_t g = 0; g < groups.size() - 1; g++) {
+        const size_t first = groups[g], last = groups[g + 1];
+        const bool backward = key[order[first]].first;
+        size_t next = first;
+        for(long explored = 0; next < last && explored < m; next++)
+            result[order[next]] = bidirectionalBfs(pairs[order[next]].first, pairs[order[next]].second,
+                    nullptr, &explored);
+        if(next == last)
+            continue;
+
+        vector<nodeindextype> ends;
+        for(size_t i = next; i < last; i++)
+            ends.push_back(backward ? pairs[order[i]].first : pairs[order[i]].second);
+        bfs(key[order[first]].second, nullptr, backward, &ends);
+        const Workspace & ws = Workspace::local();
+        for(size_t i = next; i < last; i++)
+            result[order[i]] = ws.distance(ends[i - next]);
+    }
+    return result;
+} // distances
@@ -0,0 +1,322 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Plain and decompressing block sources
+ */
+
+#include "BlockSource.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <istream>
+#include <unistd.h>
+#include <vector>
+
+#ifdef TEEXGRAPH_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TEEXGRAPH_WITH_BZIP2
+#include <bzlib.h>
+#endif
+#ifdef TEEXGRAPH_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+using namespace teexgraph;
+
+namespace {
+
+const size_t COMPRESSED_BLOCK = 1 << 20; // bytes of compressed input read at once
+
+// raw input bytes, with support for peeking at the start
+class RawSource : public BlockSource {
+  public:
+    // look at the first count bytes without consuming them
+    size_t peek(unsigned char * buffer, const size_t count) {
+        while(pending.size() < count) {
+            char c[64];
+            const long got = readRaw(c, min(sizeof(c), count - pending.size()));
+            if(got <= 0)
+                break;
+            pending.append(c, got);
+        }
+        const size_t available = min(count, pending.size());
+        memcpy(buffer, pending.data(), available);
+        return available;
+    }
+
+    long read(char * buffer, const size_t capacity) override {
+        if(pendingAt < pending.size()) {
+            const size_t count = min(capacity, pending.size() - pendingAt);
+            memcpy(buffer, pending.data() + pendingAt, count);
+            pendingAt += count;
+            return count;
+        }
+        return readRaw(buffer, capacity);
+    }
+
+  protected:
+    virtual long readRaw(char *, const size_t) = 0;
+
+  private:
+    string pending; // peeked bytes
+    size_t pendingAt = 0;
+};
+
+// bytes from a file descriptor, which may be a pipe or terminal
+class FdSource : public RawSource {
+  public:
+    FdSource(const int fd, const bool owned) : fd(fd), owned(owned) {}
+    ~FdSource() {
+        if(owned)
+            ::close(fd);
+    }
+
+  protected:
+    long readRaw(char * buffer, const size_t capacity) override {
+        long got;
+        do {
+            got = ::read(fd, buffer, capacity);
+        } while(got < 0 && errno == EINTR);
+        return got;
+    }
+
+  private:
+    const int fd;
+    const bool owned;
+};
+
+// bytes from a C++ input stream
+class IstreamSource : public RawSource {
+  public:
+    explicit IstreamSource(istream & in) : in(in) {}
+
+  protected:
+    long readRaw(char * buffer, const size_t capacity) override {
+        if(!in.good())
+            return in.bad() ? -1 : 0;
+        in.read(buffer, capacity);
+        return in.bad() ? -1 : in.gcount();
+    }
+
+  private:
+    istream & in;
+};
+
+#ifdef TEEXGRAPH_WITH_ZLIB
+// gzip (and zlib) streams; concatenated gzip members are read one after another
+class GzipSource : public BlockSource {
+  public:
+    explicit GzipSource(unique_ptr<BlockSource> input) : input(move(input)), in(COMPRESSED_BLOCK) {
+        memset(&stream, 0, sizeof(stream));
+        ok = inflateInit2(&stream, 15 + 32) == Z_OK; // 32: detect gzip/zlib header
+    }
+    ~GzipSource() { inflateEnd(&stream); }
+
+    long read(char * buffer, const size_t capacity) override {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = min<size_t>(capacity, UINT_MAX);
+        while(ok && stream.avail_out > 0) {
+            if(stream.avail_in == 0) {
+                const long got = input->read(in.data(), in.size());
+                if(got < 0 || (got == 0 && !ended)) // read error or truncated stream
+                    ok = false;
+                if(got <= 0)
+                    break;
+                stream.next_in = reinterpret_cast<Bytef *>(in.data());
+                stream.avail_in = got;
+            }
+            const int status = inflate(&stream, Z_NO_FLUSH);
+            ended = (status == Z_STREAM_END);
+            if(ended)
+                inflateReset(&stream); // another member may follow
+            else if(status != Z_OK)
+                ok = false;
+        }
+        const long produced = stream.next_out - reinterpret_cast<Bytef *>(buffer);
+        return (ok || produced > 0) ? produced : -1;
+    }
+
+  private:
+    unique_ptr<BlockSource> input;
+    vector<char> in;
+    z_stream stream;
+    bool ok, ended = false;
+};
+#endif
+
+#ifdef TEEXGRAPH_WITH_BZIP2
+// bzip2 streams; concatenated streams (as written by parallel compressors) are supported
+class Bzip2Source : public BlockSource {
+  public:
+    explicit Bzip2Source(unique_ptr<BlockSource> input) : input(move(input)), in(COMPRESSED_BLOCK) {
+        memset(&stream, 0, sizeof(stream));
+        ok = BZ2_bzDecompressInit(&stream, 0, 0) == BZ_OK;
+    }
+    ~Bzip2Source() { BZ2_bzDecompressEnd(&stream); }
+
+    long read(char * buffer, const size_t capacity) override {
+        stream.next_out = buffer;
+        stream.avail_out = min<size_t>(capacity, UINT_MAX);
+        while(ok && stream.avail_out > 0) {
+            if(stream.avail_in == 0) {
+                const long got = input->read(in.data(), in.size());
+                if(got < 0 || (got == 0 && !ended))
+                    ok = false;
+                if(got <= 0)
+                    break;
+                stream.next_in = in.data();
+                stream.avail_in = got;
+            }
+            const int status = BZ2_bzDecompress(&stream);
+            ended = (status == BZ_STREAM_END);
+            if(ended) { // restart for a possible next stream, keeping the remaining input
+                char * nextIn = stream.next_in, * nextOut = stream.next_out;
+                const unsigned int availIn = stream.avail_in, availOut = stream.avail_out;
+                BZ2_bzDecompressEnd(&stream);
+                memset(&stream, 0, sizeof(stream));
+                ok = BZ2_bzDecompressInit(&stream, 0, 0) == BZ_OK;
+                stream.next_in = nextIn;
+                stream.avail_in = availIn;
+                stream.next_out = nextOut;
+                stream.avail_out = availOut;
+            } else if(status != BZ_OK)
+                ok = false;
+        }
+        const long produced = stream.next_out - buffer;
+        return (ok || produced > 0) ? produced : -1;
+    }
+
+  private:
+    unique_ptr<BlockSource> input;
+    vector<char> in;
+    bz_stream stream;
+    bool ok, ended = false;
+};
+#endif
+
+#ifdef TEEXGRAPH_WITH_ZSTD
+// zstd streams, which may consist of multiple frames
+class ZstdSource : public BlockSource {
+  public:
+    explicit ZstdSource(unique_ptr<BlockSource> input) : input(move(input)), in(COMPRESSED_BLOCK) {
+        stream = ZSTD_createDStream();
+        ok = stream != nullptr && !ZSTD_isError(ZSTD_initDStream(stream));
+        pending = {in.data(), 0, 0};
+    }
+    ~ZstdSource() { ZSTD_freeDStream(stream); }
+
+    long read(char * buffer, const size_t capacity) override {
+        ZSTD_outBuffer out = {buffer, capacity, 0};
+        while(ok && out.pos < out.size) {
+            if(pending.pos == pending.size) {
+                const long got = input->read(in.data(), in.size());
+                if(got < 0 || (got == 0 && !ended))
+                    ok = false;
+                if(got <= 0)
+                    break;
+                pending = {in.data(), (size_t) got, 0};
+            }
+            const size_t status = ZSTD_decompressStream(stream, &out, &pending);
+            if(ZSTD_isError(status))
+                ok = false;
+            ended = (status == 0); // frame complete
+        }
+        return (ok || out.pos > 0) ? (long) out.pos : -1;
+    }
+
+  private:
+    unique_ptr<BlockSource> input;
+    vector<char> in;
+    ZSTD_DStream * stream;
+    ZSTD_inBuffer pending;
+    bool ok, ended = false;
+};
+#endif
+
+} // namespace
+
+
+// recognize a compression format by its magic bytes
+Compression teexgraph::detectCompression(const unsigned char * magic, const size_t size) {
+    if(size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+        return Compression::GZIP;
+    if(size >= 3 && magic[0] == 'B' && magic[1] == 'Z' && magic[2] == 'h')
+        return Compression::BZIP2;
+    if(size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+        return Compression::ZSTD;
+    return Compression::NONE;
+} // detectCompression
+
+
+string teexgraph::compressionName(const Compression compression) {
+    switch(compression) {
+        case Compression::GZIP: return "gzip";
+        case Compression::BZIP2: return "bzip2";
+        case Compression::ZSTD: return "zstd";
+        default: return "uncompressed";
+    }
+} // compressionName
+
+
+// put a decompressor in front of raw input if its magic bytes say so;
+// returns nullptr and sets error if that is not possible
+static unique_ptr<BlockSource> decompressed(unique_ptr<RawSource> raw, const string & name,
+        Compression & compression, string & error) {
+    unsigned char magic[4];
+    compression = detectCompression(magic, raw->peek(magic, sizeof(magic)));
+
+    switch(compression) {
+        case Compression::NONE:
+            return move(raw);
+#ifdef TEEXGRAPH_WITH_ZLIB
+        case Compression::GZIP:
+            return unique_ptr<BlockSource>(new GzipSource(move(raw)));
+#endif
+#ifdef TEEXGRAPH_WITH_BZIP2
+        case Compression::BZIP2:
+            return unique_ptr<BlockSource>(new Bzip2Source(move(raw)));
+#endif
+#ifdef TEEXGRAPH_WITH_ZSTD
+        case Compression::ZSTD:
+            return unique_ptr<BlockSource>(new ZstdSource(move(raw)));
+#endif
+        default:
+            error = name + " is " + compressionName(compression) +
+                    "-compressed, but teexGraph was built without support for it.";
+            return nullptr;
+    }
+} // decompressed
+
+
+// open a file for block reading; "-" is standard input
+unique_ptr<BlockSource> teexgraph::openBlockSource(const string & filename, Compression & compression,
+        string & error) {
+    if(filename == "-")
+        return openBlockSource(STDIN_FILENO, false, compression, error);
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        error = "file " + filename + " not found.";
+        return nullptr;
+    }
+    return decompressed(unique_ptr<RawSource>(new FdSource(fd, true)), "file " + filename,
+            compression, error);
+} // openBlockSource
+
+
+// read from a file descriptor, closing it afterwards if owned
+unique_ptr<BlockSource> teexgraph::openBlockSource(const int fd, const bool owned, Compression & compression,
+        string & error) {
+    return decompressed(unique_ptr<RawSource>(new FdSource(fd, owned)),
+            "file descriptor " + to_string(fd), compression, error);
+} // openBlockSource
+
+
+// read from an input stream, which must outlive the source
+unique_ptr<BlockSource> teexgraph::openBlockSource(istream & in, Compression & compression, string & error) {
+    return decompressed(unique_ptr<RawSource>(new IstreamSource(in)), "the input stream",
+            compression, error);
+} // openBlockSource
@@ -0,0 +1,64 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Sources of raw input bytes that are read in large blocks: files, pipes and
+ * input streams, with gzip, bzip2 or zstd compressed input recognized by its
+ * magic bytes and decompressed on the fly. Which formats are available depends on the
+ * libraries found at build time (TEEXGRAPH_WITH_ZLIB/BZIP2/ZSTD).
+ */
+
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace teexgraph {
+
+enum class Compression {
+    NONE, GZIP, BZIP2, ZSTD
+};
+
+class BlockSource {
+  public:
+    virtual ~BlockSource() = default;
+
+    // read up to capacity bytes; returns 0 at the end of the input, -1 on errors
+    virtual long read(char * buffer, const size_t capacity) = 0;
+};
+
+Compression detectCompression(const unsigned char *, const size_t);
+std::string compressionName(const Compression);
+std::unique_ptr<BlockSource> openBlockSource(const std::string &, Compression &, std::string &);
+std::unique_ptr<BlockSource> openBlockSource(const int, const bool, Compression &, std::string &);
+std::unique_ptr<BlockSource> openBlockSource(std::istream &, Compression &, std::string &);
+
+// lets a block source be read with >>
+class BlockStreamBuf : public std::streambuf {
+  public:
+    explicit BlockStreamBuf(BlockSource & source) : source(source), buffer(1 << 20) {}
+
+    bool failed() const { return error; }
+
+  protected:
+    int_type underflow() override {
+        if(gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+        const long got = source.read(buffer.data(), buffer.size());
+        if(got <= 0) {
+            error = (got < 0);
+            return traits_type::eof();
+        }
+        setg(buffer.data(), buffer.data(), buffer.data() + got);
+        return traits_type::to_int_type(*gptr());
+    }
+
+  private:
+    BlockSource & source;
+    std::vector<char> buffer;
+    bool error = false;
+};
+
+}
@@ -6,126 +6,70 @@
 
 #include <teexgraph/Graph.h>
 
+#include "Workspace.h"
+
+#include <cstdint>
+
 #include <vector>
 
 using namespace std;
 using namespace teexgraph;
 
 // Compute the closeness of node u - O(m)
-double Graph::closeness(const int u) {
+double Graph::closeness(const nodeindextype u) {
     return((double) closenessSum(u)) / ((double) nodesInWcc(wccOf(u)));
 } // closeness
 
 
 // Compute the sum of distances to all other nodes of node u - O(m)
-int Graph::closenessSum(const int u) {
-    int current, z;
-    queue<int> q;
-    vector<int> d(nodes(Scope::FULL), -1);
-
-    d[u] = 0;
-    q.push(u);
-    int total = 0;
-    while(!q.empty()) {
-        current = q.front();
-        q.pop();
-        z = neighbors(current).size();
-        for(int j = 0; j < z; j++) {
-            if(d[neighbors(current)[j]] == -1) {
-                d[neighbors(current)[j]] = d[current] + 1;
-                q.push(neighbors(current)[j]);
-                total += d[neighbors(current)[j]];
-            }
-        }
-    }
+long Graph::closenessSum(const nodeindextype u) {
+    const vector<nodeindextype> levels = bfs(u);
+    long total = 0;
+    for(size_t i = 1; i < levels.size(); i++)
+        total += (long) i * levels[i];
     return total;
 } // closenessSum
 
 
-// parallel-ready function for closeness similar to distances()
-vector<int> Graph::closenesses(const int u, vector<long> & dtotals) {
-    int current, z;
-    queue<int> q;
-    vector<int> d(nodes(Scope::FULL), -1);
-
-    d[u] = 0;
-    q.push(u);
-    //dtotals[d[u]]++;
-    while(!q.empty()) {
-        current = q.front();
-        q.pop();
-        z = neighbors(current).size();
-        for(int j = 0; j < z; j++) {
-            if(d[neighbors(current)[j]] == -1) {
-                d[neighbors(current)[j]] = d[current] + 1;
-                q.push(neighbors(current)[j]);
-                dtotals[neighbors(current)[j]] += d[neighbors(current)[j]];
-            }
-        }
-    }
-    return d;
-} // closenesses
-
-
-// compute all closeness centrality values in parallel
-vector<double> Graph::closenessCentrality(const Scope scope = Scope::LWCC, const double inputsamplesize = 1.0) {
+// compute all closeness centrality values in parallel; sampled sources are
+// drawn with the given seed
+vector<double> Graph::closenessCentrality(const Scope scope = Scope::LWCC, const double inputsamplesize = 1.0,
+        const uint64_t seed) {
 
     if(!isUndirected() || scope == Scope::LSCC || nodes(scope) < 2) {
         cerr << "Closeness centrality is only implemented for undirected graphs. Valid scopes are FULL and LWCC." << endl;
         return vector<double>(nodes(Scope::FULL), -1);
     }
 
-    double samplesize = inputsamplesize;
-    const int cpus = omp_get_num_procs();
-    int tid, a, maxi = nodes(scope);
-    double total = 0;
-    vector< vector<long> > longarray(cpus, vector<long>(nodes(Scope::FULL), 0));
-    vector<bool> done(nodes(Scope::FULL) + 1, false); // for sampling
-
-    if(samplesize < 1.0) {
-        maxi = (double) nodes(scope) * samplesize;
-    } else if(samplesize > 1.0 && samplesize < nodes(scope)) {
-        maxi = samplesize;
-        samplesize = (double) maxi / (double) nodes(scope);
-    }
-    clog << "Computing closeness values (based on a " << samplesize * 100
-            << "% sample of " << maxi << " nodes) with " << cpus << " CPUs..." << endl;
+    const int threads = omp_get_max_threads();
+    nodeindextype maxi = 0;
+    vector< vector<long> > longarray(threads, vector<long>(nodes(Scope::FULL), 0));
 
-#pragma omp parallel for schedule(dynamic, 1) private(tid, a)
-    for(int i = 0; i < maxi; i++) {
-        tid = omp_get_thread_num();
-        if(i % max(1, maxi / 20) == 0) // show status % without div by 0 errors
-            clog << " " << i / max(1, maxi / 100) << "%";
-
-        // sampled
-        if(samplesize < 1.0) {
-            a = nodes(Scope::FULL);
-            while(done[a] || !inScope(a, scope)) {
-                a = rand() % nodes(Scope::FULL);
-            }
-            closenesses(a, longarray[tid]);
-            done[a] = true;
-        }// exact computation
-        else {
-            if(!inScope(i, scope)) {
-                continue;
-            }
-            closenesses(i, longarray[tid]);
-        }
+    // the sources: a sample of distinct nodes, or all nodes in scope
+    const double samplesize = setSampleSize(maxi, scope, inputsamplesize); // also modifies maxi
+    const vector<nodeindextype> todo = getSample(maxi, scope, seed);
+
+    clog << "Computing closeness values (based on a " << samplesize * 100
+            << "% sample of " << maxi << " nodes) with " << threads << " CPUs..." << endl;
+
+    // 64 sources per BFS, see multiBfs()
+    const size_t batches = (todo.size() + 63) / 64;
+#pragma omp parallel for schedule(dynamic, 1)
+    for(size_t b = 0; b < batches; b++) {
+        if(batches > 20 && b % (batches / 20) == 0) // show status %
+            clog << " " << b * 100 / batches << "%";
+        multiBfs(todo.data() + 64 * b, min<size_t>(64, todo.size() - 64 * b), nullptr, &longarray[omp_get_thread_num()]);
     } // for
 
     clog << " " << "Done." << endl << endl;
 
     // merge all cpu results
     vector<long> alllongarray(nodes(Scope::FULL), 0);
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
-        for(int j = 0; j < cpus; j++) {
-            alllongarray[i] += (double) longarray[j][i];
-            total += (i * longarray[j][i]);
-        }
-    }
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++)
+        for(int j = 0; j < threads; j++)
+            alllongarray[i] += longarray[j][i];
     vector<double> results(nodes(Scope::FULL), 0.0);
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         results[i] = 1.0 / ((long double) alllongarray[i] / (long double) maxi);
         if(scope == Scope::FULL && !inScope(i, Scope::LWCC))
             results[i] = closeness(i);
@@ -142,7 +86,7 @@ vector<double> Graph::degreeCentrality() {
 // outdegreeCentrality
 vector<double> Graph::outdegreeCentrality() {
     vector<double> outDeg(nodes(Scope::FULL)); // outdegrees
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         outDeg[i] = (signed)neighbors(i).size();
     }
     return outDeg;
@@ -151,7 +95,7 @@ vector<double> Graph::outdegreeCentrality() {
 // indegreeCentrality
 vector<double> Graph::indegreeCentrality() {
     vector<double> inDeg(nodes(Scope::FULL)); // indegrees
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         inDeg[i] = (signed)revNeighbors(i).size();
     }
     return inDeg;
@@ -163,9 +107,9 @@ vector<double> Graph::eccentricityCentrality(const Scope scope = Scope::FULL) {
         cerr << "Eccentricity centrality is only implemented for undirected graphs. Valid scopes are FULL and LWCC." << endl;
         return vector<double>(nodes(Scope::FULL), -1);
     }
-    vector<int> eccs = eccentricitiesBD();
+    vector<nodeindextype> eccs = eccentricitiesBD();
     vector<double> centralities(nodes(Scope::FULL), -1);
-    for(int i = 0; i < nodes(Scope::FULL); i++)
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++)
         if(inScope(i, Scope::LWCC))
             centralities[i] = eccs[i];
         else if(scope == Scope::FULL)
@@ -173,113 +117,89 @@ vector<double> Graph::eccentricityCentrality(const Scope scope = Scope::FULL) {
     return centralities;
 } // eccentricityCentrality
 
-// Compute betweenness centrality cf. Brandes 2001 algorithm
-vector<double> Graph::betweennessCentrality(const Scope scope = Scope::FULL, const double inputsamplesize = 1.0) {
+// Compute betweenness centrality cf. Brandes 2001 algorithm; sampled sources
+// are drawn with the given seed
+vector<double> Graph::betweennessCentrality(const Scope scope = Scope::FULL, const double inputsamplesize = 1.0,
+        const uint64_t seed) {
 
     if(!isUndirected() || scope == Scope::LSCC || nodes(scope) < 2) {
         cerr << "Betweenness centrality is only implemented for undirected graphs. Valid scopes are FULL and LWCC." << endl;
         return vector<double>(nodes(Scope::FULL), -1);
     }
 
-    const int cpus = omp_get_num_procs();
-    vector< vector<long double> > doublelongarray(cpus, vector<long double>(nodes(Scope::FULL), 0));
-    double samplesize = inputsamplesize;
-    int tid, maxi = nodes(scope);
-    vector<bool> done(nodes(Scope::FULL) + 1, false); // for sampling
-
-    if(samplesize < 1.0) {
-        maxi = (double) nodes(scope) * samplesize;
-    } else if(samplesize > 1.0 && samplesize < nodes(scope)) {
-        maxi = samplesize;
-        samplesize = (double) maxi / (double) nodes(scope);
-    }
-
-    int until = maxi;
+    const int threads = omp_get_max_threads();
+    vector< vector<long double> > doublelongarray(threads, vector<long double>(nodes(Scope::FULL), 0));
+    int tid;
+    nodeindextype maxi = 0;
 
-    int prevs = -1;
+    // the sources: a sample of distinct nodes, or all nodes in scope
+    const double samplesize = setSampleSize(maxi, scope, inputsamplesize); // also modifies maxi
+    const vector<nodeindextype> todo = getSample(maxi, scope, seed);
+    const nodeindextype until = todo.size();
 
     clog << "Computing betweenness values (based on a " << samplesize * 100
-            << "% sample of " << until << " nodes) with " << cpus << " CPUs..." << endl;
+            << "% sample of " << maxi << " nodes) with " << threads << " CPUs..." << endl;
 
 #pragma omp parallel for schedule(dynamic, 1) private(tid)
-    for(int s = 0; s < until; s++) {
+    for(nodeindextype k = 0; k < until; k++) {
         tid = omp_get_thread_num();
-
-        vector<double> sp;
-        vector<int> d;
-        vector< vector<int> > P(nodes(Scope::FULL));
-        vector<double> delta;
-        queue<int> Q;
-        stack<int> S;
-        int v, w;
-
-        if(s % max(1, until / 20) == 0) // show status % without div by 0 errors
-            clog << " " << s / max(1, until / 100) << "%";
-
-        if(samplesize < 1.0) {
-            prevs = s;
-            do {
-                s = rand() % nodes(Scope::FULL);
-            } while(!inScope(s, scope));
-        } // if
-
-        sp.assign(nodes(Scope::FULL), 0);
-        d.assign(nodes(Scope::FULL), nodes(Scope::FULL) + 1);
-        P.assign(nodes(Scope::FULL), vector<int>());
-        delta.assign(nodes(Scope::FULL), 0);
-
-        sp[s] = 1;
-        d[s] = 0;
-        Q.push(s);
-
-        while(!Q.empty()) {
-            v = Q.front();
-            Q.pop();
-            S.push(v);
-
-            const int z = (signed)neighbors(v).size();
-            for(int i = 0; i < z; i++) {
-                int w = neighbors(v)[i];
-                if(d[w] == nodes(Scope::FULL) + 1) {
-                    d[w] = d[v] + 1;
-                    Q.push(w);
-                }
-                if(d[w] == d[v] + 1) {
-                    sp[w] += sp[v];
-                    P[w].push_back(v);
+        const nodeindextype s = todo[k];
+
+        Workspace & ws = Workspace::local();
+
+        if(k % max<nodeindextype>(1, until / 20) == 0) // show status % without div by 0 errors
+            clog << " " << k / max<nodeindextype>(1, until / 100) << "%";
+
+        // count the shortest paths from s in BFS order; the paths and
+        // dependencies of a node are reset when it is visited
+        ws.start(nodes(Scope::FULL));
+        ws.paths.resize(nodes(Scope::FULL));
+        ws.dependencies.resize(nodes(Scope::FULL));
+        ws.visit(s, 0);
+        ws.paths[s] = 1;
+        ws.dependencies[s] = 0;
+        ws.order.push_back(s);
+        for(size_t i = 0; i < ws.order.size(); i++) {
+            const nodeindextype v = ws.order[i], dv = ws.distance(v);
+            E.forEach(v, [&](const nodeindextype w) {
+                if(!ws.visited(w)) {
+                    ws.visit(w, dv + 1);
+                    ws.paths[w] = 0;
+                    ws.dependencies[w] = 0;
+                    ws.order.push_back(w);
                 }
-            } // for
-        } // while
-
-        while(!S.empty()) {
-            w = S.top();
-            S.pop();
-            for(size_t j = 0; j < P[w].size(); j++) {
-                v = P[w][j];
-                delta[v] += ((double) sp[v] / (double) sp[w])*(1.0 + delta[w]);
-            }
+                if(ws.distance(w) == dv + 1)
+                    ws.paths[w] += ws.paths[v];
+            }); // for
+        } // for
+
+        // accumulate dependencies in reverse BFS order; the predecessors of w
+        // are its neighbors one level closer to s. each dependencies[v] gets
+        // one term per successor w, in reverse BFS order of w, as it did with
+        // predecessor lists, so the sums are added up in the same order
+        for(size_t i = ws.order.size(); i-- > 0; ) {
+            const nodeindextype w = ws.order[i], dw = ws.distance(w);
+            E.forEach(w, [&](const nodeindextype v) {
+                if(ws.distance(v) == dw - 1)
+                    ws.dependencies[v] += (ws.paths[v] / ws.paths[w]) * (1.0 + ws.dependencies[w]);
+            });
             if(w != s)
-                doublelongarray[tid][w] += (long double) delta[w];
+                doublelongarray[tid][w] += (long double) ws.dependencies[w];
         }
-
-        if(samplesize < 1.0) {
-            s = prevs;
-        }
-
     }
 
     // merge all cpu results
     long double maxval = 0;
     vector<long double> totals(nodes(Scope::FULL), 0);
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
-        for(int j = 0; j < cpus; j++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
+        for(int j = 0; j < threads; j++) {
             totals[i] += (double) doublelongarray[j][i];
         }
         maxval = max(maxval, totals[i]);
     }
 
     vector<double> centralities(nodes(Scope::FULL), 0);
-    for(int i = 0; i < nodes(Scope::FULL); i++) {
+    for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
         centralities[i] = totals[i] / maxval;
     }
 
@@ -298,23 +218,24 @@ vector<double> Graph::pageRankCentrality() {
 
     for(int k = 0; k < iterations; k++) {
         // do one iteration
-        int z;
+        nodeindextype z;
         double currentvalue;
         centralitiesNext.assign(nodes(Scope::FULL), 0);
 
         // compute new pageranks
-        for(int i = 0; i < nodes(Scope::FULL); i++) {
-            z = (signed)neighbors(i).size();
+        for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
+            z = E.degree(i);
             currentvalue = centralities[i] / (double) z;
-            for(int j = 0; j < z; j++)
-                centralitiesNext[neighbors(i)[j]] += currentvalue;
+            E.forEach(i, [&](const nodeindextype j) {
+                centralitiesNext[j] += currentvalue;
+            });
         }
 
         // compute errors
         error = 0.0;
         minval = 1;
         maxval = 0;
-        for(int i = 0; i < nodes(Scope::FULL); i++) {
+        for(nodeindextype i = 0; i < nodes(Scope::FULL); i++) {
             error += (centralities[i] - centralitiesNext[i])*(centralities[i] - centralitiesNext[i]);
             centralities[i] = ((1 - d) / nodes(Scope::FULL))+(d * centralitiesNext[i]);
             minval = min(minval, centralities[i]);
@@ -0,0 +1,444 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Exact distance index for undirected graphs, by pruned landmark labeling.
+ * See the following paper for details:
+ *
+ * T. Akiba, Y. Iwata and Y. Yoshida, Fast Exact Shortest-Path Distance Queries
+ * on Large Networks by Pruned Landmark Labeling, in Proceedings of the 2013 ACM
+ * SIGMOD International Conference on Management of Data (SIGMOD 2013),
+ * pp. 349-360, 2013. http://dx.doi.org/10.1145/2463676.2465315
+ *
+ * Nodes are ranked by decreasing degree. The highest ranked nodes, each with
+ * up to 64 of its neighbors, become bit-parallel roots: a single BFS from a
+ * root gives the distance of every node to the root and to each of these
+ * neighbors, stored as a distance and two bitmasks. These BFSs run in
+ * parallel. Then a BFS is done from every other node in order of rank, which
+ * adds its rank to the label of each node it reaches, except that it does not
+ * go beyond nodes whose distance the labels found so far already give. On
+ * small-world graphs the high-degree nodes cover most shortest paths, so the
+ * later BFSs are pruned early and labels stay small. After the first roots,
+ * the pruned BFSs run in batches of one per thread, each pruned by the labels
+ * of the earlier batches only. This can only add entries to the labels.
+ */
+
+#include <teexgraph/Graph.h>
+
+#include "DistanceIndex.h"
+#include "Workspace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace teexgraph;
+
+namespace {
+
+const nodeindextype SEQUENTIAL_ROOTS = 1024; // the first pruned BFSs run one at a time
+
+const char INDEX_MAGIC[8] = {'t', 'e', 'e', 'x', 'd', 'i', 's', 't'};
+const uint32_t INDEX_VERSION = 1;
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint16_t nodeBytes; // sizeof(nodeindextype) of the writer
+    uint16_t roots;
+    int64_t n, m, entries;
+};
+static_assert(sizeof(IndexHeader) == 40, "index header must not contain padding");
+
+
+// BFS from bit-parallel root r and its selected neighbors, storing the
+// distance of node u to r at dist[u * stride] and the bitmasks of the selected
+// neighbors one closer to u and as close to u as r at sets[2 * u * stride] and
+// sets[2 * u * stride + 1]. returns false if a distance does not fit
+bool bitParallelBfs(const Adjacency & E, const nodeindextype r, const vector<nodeindextype> & selected,
+        uint8_t * dist, uint64_t * sets, const int stride) {
+    const auto d = [&](const nodeindextype u) -> uint8_t & { return dist[(size_t) u * stride]; };
+    const auto s = [&](const nodeindextype u) -> uint64_t * { return sets + 2 * (size_t) u * stride; };
+
+    vector<nodeindextype> queue(1, r);
+    d(r) = 0;
+    for(size_t k = 0; k < selected.size(); k++) {
+        queue.push_back(selected[k]);
+        d(selected[k]) = 1;
+        s(selected[k])[0] = (uint64_t) 1 << k;
+    }
+
+    // edges within a level pass on the "as close" masks, edges to the next
+    // level both masks
+    vector< pair<nodeindextype, nodeindextype> > siblings, children;
+    for(size_t begin = 0, end = 1; begin < queue.size(); begin = end, end = queue.size()) {
+        const int level = d(queue[begin]);
+        if(level + 1 >= DistanceIndex::UNREACHABLE)
+            return false;
+        siblings.clear();
+        children.clear();
+        for(size_t i = begin; i < end; i++) {
+            const nodeindextype v = queue[i];
+            for(const nodeindextype w : E[v]) {
+                if(d(w) < level)
+                    continue;
+                if(d(w) == level) {
+                    if(v < w)
+                        siblings.push_back(make_pair(v, w));
+                } else {
+                    if(d(w) == DistanceIndex::UNREACHABLE) {
+                        queue.push_back(w);
+                        d(w) = level + 1;
+                    }
+                    children.push_back(make_pair(v, w));
+                }
+            }
+        }
+        for(const auto & edge : siblings) {
+            s(edge.first)[1] |= s(edge.second)[0];
+            s(edge.second)[1] |= s(edge.first)[0];
+        }
+        for(const auto & edge : children) {
+            s(edge.second)[0] |= s(edge.first)[0];
+            s(edge.second)[1] |= s(edge.first)[1];
+        }
+    }
+    return true;
+} // bitParallelBfs
+
+// read or write count elements of an index section, or throw
+template <typename T>
+void writeSection(FILE * out, const T * data, const size_t count) {
+    if(count == 0) // e.g. without bit-parallel roots; data may be null
+        return;
+    if(fwrite(data, sizeof(T), count, out) != count)
+        throw runtime_error("writing the distance index failed");
+} // writeSection
+
+template <typename T>
+void readSection(FILE * in, vector<T> & data, const size_t count) {
+    data.resize(count);
+    if(count == 0)
+        return;
+    if(fread(data.data(), sizeof(T), count, in) != count)
+        throw runtime_error("the distance index is truncated");
+} // readSection
+
+} // namespace
+
+
+const int DistanceIndex::MAX_ROOTS;
+const uint8_t DistanceIndex::UNREACHABLE;
+
+
+// build the index of the n nodes with the given symmetric lists
+void DistanceIndex::build(const Adjacency & E, const nodeindextype nodecount, const int rootcount) {
+    n = nodecount;
+
+    // rank the nodes by decreasing degree
+    vector<nodeindextype> order(n), rank(n);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](const nodeindextype a, const nodeindextype b) {
+        return E.degree(a) > E.degree(b);
+    });
+    for(nodeindextype k = 0; k < n; k++)
+        rank[order[k]] = k;
+
+    // choose the bit-parallel roots: the highest ranked unused node and up to
+    // 64 of its highest ranked unused neighbors
+    vector<bool> used(n, false);
+    vector<nodeindextype> rootNodes;
+    vector< vector<nodeindextype> > selected;
+    for(nodeindextype k = 0; k < n && (int) rootNodes.size() < min(rootcount, MAX_ROOTS); k++) {
+        const nodeindextype r = order[k];
+        if(used[r])
+            continue;
+        used[r] = true;
+        vector<nodeindextype> neighbors;
+        for(const nodeindextype w : E[r])
+            if(!used[w])
+                neighbors.push_back(w);
+        sort(neighbors.begin(), neighbors.end(), [&](const nodeindextype a, const nodeindextype b) {
+            return rank[a] < rank[b];
+        });
+        neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        if(neighbors.size() > 64)
+            neighbors.resize(64);
+        for(const nodeindextype w : neighbors)
+            used[w] = true;
+        rootNodes.push_back(r);
+        selected.push_back(neighbors);
+    }
+    roots = rootNodes.size();
+    rootDistance.assign((size_t) n * roots, UNREACHABLE);
+    rootSets.assign(2 * (size_t) n * roots, 0);
+    bool tooFar = false;
+#pragma omp parallel for schedule(dynamic, 1) reduction(||:tooFar)
+    for(int i = 0; i < roots; i++)
+        tooFar = !bitParallelBfs(E, rootNodes[i], selected[i], rootDistance.data() + i,
+                rootSets.data() + 2 * i, roots) || tooFar;
+    if(tooFar)
+        throw overflow_error("the graph has distances too large for the distance index");
+
+    // pruned BFSs from the other nodes, adding (rank, distance) entries to the
+    // labels of the nodes they reach; in batches, in order of rank
+    struct Entry {
+        nodeindextype hub;
+        uint8_t distance;
+    };
+    vector< vector<Entry> > labels(n);
+    vector< vector<uint8_t> > known(omp_get_max_threads()); // per thread, distance of the root to each hub
+    vector<nodeindextype> batch;
+    vector< vector< pair<nodeindextype, uint8_t> > > found;
+    for(nodeindextype k = 0; k < n && !tooFar; ) {
+        const size_t size = (k < SEQUENTIAL_ROOTS) ? 1 : known.size();
+        batch.clear();
+        for(; k < n && batch.size() < size; k++)
+            if(!used[order[k]])
+                batch.push_back(k);
+        found.resize(batch.size());
+
+#pragma omp parallel for schedule(dynamic, 1) if(batch.size() > 1) reduction(||:tooFar)
+        for(size_t j = 0; j < batch.size(); j++) {
+            const nodeindextype r = order[batch[j]];
+            vector<uint8_t> & rootKnown = known[omp_get_thread_num()];
+            rootKnown.resize(n, UNREACHABLE);
+            for(const Entry & entry : labels[r])
+                rootKnown[entry.hub] = entry.distance;
+
+            Workspace & ws = Workspace::local();
+            ws.start(n);
+            ws.visit(r, 0);
+            ws.order.push_back(r);
+            found[j].clear();
+            for(size_t head = 0; head < ws.order.size(); head++) {
+                const nodeindextype v = ws.order[head], d = ws.distance(v);
+
+                // nodes used as bit-parallel roots are covered by them
+                if(used[v] || rootsDistance(r, v, d) <= d)
+                    continue;
+                bool covered = false;
+                for(const Entry & entry : labels[v])
+                    if(rootKnown[entry.hub] + entry.distance <= d) {
+                        covered = true;
+                        break;
+                    }
+                if(covered)
+                    continue;
+
+                found[j].push_back(make_pair(v, (uint8_t) d));
+                if(d + 1 >= UNREACHABLE) {
+                    tooFar = true;
+                    continue;
+                }
+                for(const nodeindextype w : E[v])
+                    if(!ws.visited(w)) {
+                        ws.visit(w, d + 1);
+                        ws.order.push_back(w);
+                    }
+            }
+            for(const Entry & entry : labels[r])
+                rootKnown[entry.hub] = UNREACHABLE;
+        }
+
+        // labels stay sorted by hub, as batches are taken in order of rank
+        for(size_t j = 0; j < batch.size(); j++)
+            for(const auto & reached : found[j])
+                labels[reached.first].push_back(Entry{batch[j], reached.second});
+    }
+    if(tooFar)
+        throw overflow_error("the graph has distances too large for the distance index");
+
+    // store the labels one after the other
+    labelStart.assign(n + 1, 0);
+    for(nodeindextype u = 0; u < n; u++)
+        labelStart[u + 1] = labelStart[u] + labels[u].size();
+    hubs.resize(labelStart[n]);
+    hubDistance.resize(labelStart[n]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype u = 0; u < n; u++) {
+        for(size_t i = 0; i < labels[u].size(); i++) {
+            hubs[labelStart[u] + i] = labels[u][i].hub;
+            hubDistance[labelStart[u] + i] = labels[u][i].distance;
+        }
+        vector<Entry>().swap(labels[u]);
+    }
+} // build
+
+
+// smallest distance from u to v through the bit-parallel roots and their
+// selected neighbors if it is at most bound, otherwise a value above bound
+int DistanceIndex::rootsDistance(const nodeindextype u, const nodeindextype v, const int bound) const {
+    const uint8_t * du = rootDistance.data() + (size_t) u * roots, * dv = rootDistance.data() + (size_t) v * roots;
+    const uint64_t * su = rootSets.data() + 2 * (size_t) u * roots, * sv = rootSets.data() + 2 * (size_t) v * roots;
+    int best = bound + 1;
+    for(int i = 0; i < roots; i++) {
+        int d = du[i] + dv[i];
+        if(d - 2 >= best)
+            continue;
+        if(su[2 * i] & sv[2 * i])
+            d -= 2;
+        else if((su[2 * i] & sv[2 * i + 1]) | (su[2 * i + 1] & sv[2 * i]))
+            d -= 1;
+        best = min(best, d);
+    }
+    return best;
+} // rootsDistance
+
+
+// distance from u to v: the smallest sum over the shared roots and hubs
+nodeindextype DistanceIndex::distance(const nodeindextype u, const nodeindextype v) const {
+    if(u == v)
+        return 0;
+    int best = rootsDistance(u, v, UNREACHABLE - 1);
+    for(uint64_t i = labelStart[u], j = labelStart[v]; i < labelStart[u + 1] && j < labelStart[v + 1]; ) {
+        if(hubs[i] == hubs[j]) {
+            best = min(best, hubDistance[i] + hubDistance[j]);
+            i++;
+            j++;
+        } else if(hubs[i] < hubs[j])
+            i++;
+        else
+            j++;
+    }
+    return (best >= UNREACHABLE) ? -1 : best;
+} // distance
+
+
+// write the index to a file, along with the size of the graph it belongs to
+void DistanceIndex::save(const string & filename, const long m) const {
+    FILE * const out = fopen(filename.c_str(), "wb");
+    if(out == nullptr)
+        throw runtime_error("cannot write to " + filename);
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version = INDEX_VERSION;
+    header.nodeBytes = sizeof(nodeindextype);
+    header.roots = roots;
+    header.n = n;
+    header.m = m;
+    header.entries = hubs.size();
+    try {
+        writeSection(out, &header, 1);
+        writeSection(out, rootDistance.data(), rootDistance.size());
+        writeSection(out, rootSets.data(), rootSets.size());
+        writeSection(out, labelStart.data(), labelStart.size());
+        writeSection(out, hubs.data(), hubs.size());
+        writeSection(out, hubDistance.data(), hubDistance.size());
+    } catch(const runtime_error &) {
+        fclose(out);
+        throw;
+    }
+    if(fclose(out) != 0)
+        throw runtime_error("writing the distance index failed");
+} // save
+
+
+// read an index written by save() for a graph with n nodes and m edges
+void DistanceIndex::load(const string & filename, const nodeindextype nodecount, const long m) {
+    FILE * const in = fopen(filename.c_str(), "rb");
+    if(in == nullptr)
+        throw runtime_error("file " + filename + " not found");
+    try {
+        IndexHeader header;
+        if(fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0)
+            throw runtime_error("file " + filename + " is not a distance index");
+        if(header.version != INDEX_VERSION || header.nodeBytes != sizeof(nodeindextype))
+            throw runtime_error("distance index version " + to_string(header.version) + " with " +
+                    to_string(header.nodeBytes) + "-byte node ids is not supported by this build");
+        if(header.n != nodecount || header.m != m || header.roots > MAX_ROOTS || header.entries < 0)
+            throw runtime_error("the distance index does not belong to this graph");
+        n = nodecount;
+        roots = header.roots;
+        readSection(in, rootDistance, (size_t) n * roots);
+        readSection(in, rootSets, 2 * (size_t) n * roots);
+        readSection(in, labelStart, n + 1);
+        if(labelStart[n] != (uint64_t) header.entries)
+            throw runtime_error("the distance index is corrupt");
+        readSection(in, hubs, header.entries);
+        readSection(in, hubDistance, header.entries);
+    } catch(const runtime_error &) {
+        fclose(in);
+        throw;
+    }
+    fclose(in);
+} // load
+
+
+// build an exact distance index of the undirected graph with the given number
+// of bit-parallel roots, after which distance() and distances() use the index
+bool Graph::buildDistanceIndex(const int roots) {
+    if(!loaded) {
+        cerr << "Error: no graph is loaded." << endl;
+        return false;
+    }
+    if(!undirected) {
+        cerr << "Error: the distance index requires an undirected graph." << endl;
+        return false;
+    }
+    sortEdgeList();
+    clog << "Building distance index with " << roots << " bit-parallel roots..." << endl;
+    shared_ptr<DistanceIndex> index = make_shared<DistanceIndex>();
+    try {
+        index->build(E, n, roots);
+    } catch(const overflow_error & e) {
+        cerr << "Error: " << e.what() << "." << endl;
+        return false;
+    }
+    labels = index;
+    clog << "- " << index->labelEntries() << " label entries, "
+            << (n > 0 ? (double) index->labelEntries() / n : 0.0) << " per node" << endl;
+    clog << "Distance index built." << endl << endl;
+    return true;
+} // buildDistanceIndex
+
+
+// save the distance index, to be reloaded with loadDistanceIndex() for the
+// same graph
+bool Graph::saveDistanceIndex(const string filename) const {
+    if(!labels) {
+        cerr << "Error: no distance index is built." << endl;
+        return false;
+    }
+    clog << "Saving distance index to " << filename << " ..." << endl;
+    try {
+        labels->save(filename, m);
+    } catch(const runtime_error & e) {
+        cerr << "Error: " << e.what() << "." << endl;
+        return false;
+    }
+    clog << "Distance index saved." << endl << endl;
+    return true;
+} // saveDistanceIndex
+
+
+// load a distance index saved with saveDistanceIndex() for this graph
+bool Graph::loadDistanceIndex(const string filename) {
+    if(!loaded || !undirected) {
+        cerr << "Error: no undirected graph is loaded." << endl;
+        return false;
+    }
+    sortEdgeList();
+    clog << "Loading distance index from " << filename << " ..." << endl;
+    shared_ptr<DistanceIndex> index = make_shared<DistanceIndex>();
+    try {
+        index->load(filename, n, m);
+    } catch(const runtime_error & e) {
+        cerr << "Error: " << e.what() << "." << endl;
+        return false;
+    }
+    labels = index;
+    clog << "Distance index loaded." << endl << endl;
+    return true;
+} // loadDistanceIndex
+
+
+// has a distance index been built or loaded?
+bool Graph::hasDistanceIndex() const {
+    return labels != nullptr;
+} // hasDistanceIndex
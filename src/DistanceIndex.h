@@ -0,0 +1,58 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Exact distance index of an undirected graph by pruned landmark labeling (see
+ * DistanceIndex.cpp). Every node has a label of (hub, distance) pairs such that
+ * for any two nodes, some hub on a shortest path between them occurs in both
+ * labels, plus the distances to a number of bit-parallel roots and to their
+ * neighbors. The distance of two nodes is the smallest sum over their shared
+ * hubs and roots, found by merging the two labels, which are sorted by hub.
+ */
+
+#pragma once
+
+#include <teexgraph/Adjacency.h>
+#include <teexgraph/IndexTypes.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace teexgraph {
+
+class DistanceIndex {
+  public:
+    static const int MAX_ROOTS = 64; // bit-parallel roots at most
+    static const uint8_t UNREACHABLE = 255; // larger than any stored distance
+
+    // build the index of the n nodes with the given (symmetric) lists, using
+    // the given number of bit-parallel roots. throws an overflow_error if the
+    // graph has a distance of UNREACHABLE or more
+    void build(const Adjacency & E, const nodeindextype n, const int roots);
+
+    // distance from u to v, or -1 if v cannot be reached from u
+    nodeindextype distance(const nodeindextype u, const nodeindextype v) const;
+
+    // write the index to a file, and read it back for a graph with n nodes and
+    // m edges; both throw a runtime_error if this fails
+    void save(const std::string & filename, const long m) const;
+    void load(const std::string & filename, const nodeindextype n, const long m);
+
+    nodeindextype nodes() const { return n; }
+    int rootCount() const { return roots; }
+    size_t labelEntries() const { return hubs.size(); }
+
+  private:
+    nodeindextype n = 0;
+    int roots = 0;
+    std::vector<uint8_t> rootDistance; // [u * roots + i]: distance of u to root i
+    std::vector<uint64_t> rootSets; // [2 * (u * roots + i)]: neighbors of root i one closer to u, and as close
+    std::vector<uint64_t> labelStart; // label of u is at [labelStart[u], labelStart[u + 1])
+    std::vector<nodeindextype> hubs; // hubs of the labels, by rank, increasing within a label
+    std::vector<uint8_t> hubDistance; // distance to each hub
+
+    // smallest distance over the bit-parallel roots, if at most bound
+    int rootsDistance(const nodeindextype u, const nodeindextype v, const int bound) const;
+};
+
+}
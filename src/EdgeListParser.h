@@ -0,0 +1,222 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Parallel parsing of an in-memory edge list in [u v] format. The buffer is
+ * split into newline-aligned chunks that are parsed concurrently; each chunk
+ * yields a flat [u v u v ...] buffer so that the chunks together are in file order.
+ * Identifiers are integers, or tokens pointing into the buffer for string
+ * identifiers (IdMapping::STRING).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <omp.h>
+#include <type_traits>
+#include <vector>
+
+#include <teexgraph/StringPool.h> // string identifiers
+
+namespace teexgraph {
+
+// true if the character may start an edge line (cf. the header skipping rule)
+inline bool isAlphanumeric(const char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+} // isAlphanumeric
+
+
+// skip leading whitespace and any first lines that do not start with an
+// alphanumeric character; these might contain graph meta information
+inline size_t skipHeader(const char * data, const size_t size) {
+    size_t i = 0;
+    while(i < size && (data[i] == '\n' || data[i] == '\r' || data[i] == '\t' || data[i] == ' '))
+        i++;
+    while(i < size && !isAlphanumeric(data[i])) {
+        const void * newline = memchr(data + i, '\n', size - i);
+        i = (newline == nullptr) ? size : (static_cast<const char *>(newline) - data) + 1;
+    }
+    return i;
+} // skipHeader
+
+
+// check whether all eight bytes of a little-endian word are ASCII digits
+inline bool isEightDigits(const uint64_t chunk) {
+    return (((chunk & 0xF0F0F0F0F0F0F0F0) |
+            (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333);
+} // isEightDigits
+
+
+// convert eight ASCII digits in a little-endian word to their value, without branches
+inline uint64_t parseEightDigits(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FF;
+    const uint64_t mul1 = 0x000F424000000064; // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001; // 1 + (10000 << 32)
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);
+    return (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+} // parseEightDigits
+
+
+// scan an optionally signed decimal integer at p; returns the position after
+// it, or nullptr if there is no number at p
+template <typename Integer>
+inline const char * scanInteger(const char * p, const char * end, Integer & value) {
+    typedef typename std::make_unsigned<Integer>::type Unsigned;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    const char * start = p;
+    Unsigned x = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // consume eight digits at a time while we can
+    while(end - p >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, p, 8);
+        if(!isEightDigits(chunk))
+            break;
+        x = x * 100000000 + (Unsigned) parseEightDigits(chunk);
+        p += 8;
+    }
+#endif
+    while(p < end && (unsigned char)(*p - '0') <= 9) {
+        x = x * 10 + (Unsigned)(*p - '0');
+        p++;
+    }
+    if(p == start)
+        return nullptr;
+    value = negative ? (Integer)(0 - x) : (Integer) x;
+    return p;
+} // scanInteger
+
+
+// parse [u v] lines in [begin, end) and append the pairs to out; anything after
+// the second number on a line is ignored. returns the start of the first line
+// that could not be parsed, or end if all lines were fine
+template <typename Integer>
+const char * parseEdgeLines(const char * begin, const char * end, std::vector<Integer> & out) {
+    const char * p = begin;
+    Integer u, v;
+    while(p < end) {
+        const char * line = p;
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        if(p == end)
+            break;
+        if(*p == '\n') { // empty line
+            p++;
+            continue;
+        }
+        p = scanInteger(p, end, u);
+        if(p == nullptr || p == end || (*p != ' ' && *p != '\t'))
+            return line;
+        while(p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        p = scanInteger(p, end, v);
+        if(p == nullptr)
+            return line;
+        out.push_back(u);
+        out.push_back(v);
+        const void * newline = memchr(p, '\n', end - p);
+        p = (newline == nullptr) ? end : static_cast<const char *>(newline) + 1;
+    }
+    return end;
+} // parseEdgeLines
+
+
+// scan a string identifier at p: a run of characters other than whitespace
+inline const char * scanToken(const char * p, const char * end, StringToken & token) {
+    const char * start = p;
+    while(p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+        p++;
+    if(p == start)
+        return nullptr;
+    token.data = start;
+    token.length = p - start;
+    token.hash = hashString(start, p - start);
+    return p;
+} // scanToken
+
+
+// parse [u v] lines of string identifiers; as parseEdgeLines above, but the
+// tokens point into [begin, end), which must outlive them
+inline const char * parseEdgeLines(const char * begin, const char * end, std::vector<StringToken> & out) {
+    const char * p = begin;
+    StringToken u, v;
+    while(p < end) {
+        const char * line = p;
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        if(p == end)
+            break;
+        if(*p == '\n') { // empty line
+            p++;
+            continue;
+        }
+        p = scanToken(p, end, u);
+        if(p == nullptr || p == end || (*p != ' ' && *p != '\t'))
+            return line;
+        while(p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        p = scanToken(p, end, v);
+        if(p == nullptr)
+            return line;
+        out.push_back(u);
+        out.push_back(v);
+        const void * newline = memchr(p, '\n', end - p);
+        p = (newline == nullptr) ? end : static_cast<const char *>(newline) + 1;
+    }
+    return end;
+} // parseEdgeLines
+
+
+// split [begin, end) in at most parts pieces that each start at a new line
+inline std::vector<const char *> splitLines(const char * begin, const char * end, const size_t parts) {
+    std::vector<const char *> bounds(1, begin);
+    const size_t size = end - begin;
+    for(size_t k = 1; k < parts; k++) {
+        const char * p = std::max(begin + (size / parts) * k, bounds.back());
+        const void * newline = memchr(p, '\n', end - p);
+        if(newline == nullptr)
+            break;
+        bounds.push_back(static_cast<const char *>(newline) + 1);
+    }
+    bounds.push_back(end);
+    return bounds;
+} // splitLines
+
+
+// parse an edge list in parallel. like reading with >>, everything from the
+// first line that cannot be parsed onwards is ignored; stoppedAt tells where
+// that was (or equals end)
+template <typename Integer>
+std::vector< std::vector<Integer> > parseEdgeList(const char * begin, const char * end,
+        const char * & stoppedAt) {
+    const size_t minChunk = 1 << 20; // don't bother splitting below 1MB
+    const size_t parts = std::max<size_t>(1, std::min<size_t>(
+            4 * omp_get_max_threads(), (end - begin) / minChunk));
+    const std::vector<const char *> bounds = splitLines(begin, end, parts);
+    const int chunks = (signed) bounds.size() - 1;
+    std::vector< std::vector<Integer> > buffers(chunks);
+    std::vector<const char *> stops(chunks);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int i = 0; i < chunks; i++) {
+        buffers[i].reserve((bounds[i + 1] - bounds[i]) / 8);
+        stops[i] = parseEdgeLines(bounds[i], bounds[i + 1], buffers[i]);
+    }
+
+    stoppedAt = end;
+    for(int i = 0; i < chunks; i++)
+        if(stops[i] != bounds[i + 1]) {
+            stoppedAt = stops[i];
+            buffers.resize(i + 1);
+            break;
+        }
+    return buffers;
+} // parseEdgeList
+
+}
@@ -0,0 +1,123 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Sequential passes over the out-lists of a snapshot on disk, for the
+ * semi-external mode (see SemiExternal.cpp). The lists are divided in blocks of
+ * whole lists of about blockBytes each. A pass reads the blocks that hold at
+ * least one node of interest in file order, with one large pread per block on a
+ * separate thread, which prefetches the next blocks while the current one is
+ * being processed. Blocks without nodes of interest are skipped altogether.
+ */
+
+#pragma once
+
+#include "BoundedQueue.h"
+
+#include <teexgraph/IndexTypes.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace teexgraph {
+
+class EdgeScanner {
+  public:
+    // the targets of node u are at byte targetsAt + offsets[u] * sizeof(nodeindextype)
+    // of the file; offsets must outlive the scanner
+    EdgeScanner(const std::string & filename, const size_t targetsAt, const edgeindextype * offsets,
+            const nodeindextype n, const size_t blockBytes = 1 << 26) :
+            targetsAt(targetsAt), offsets(offsets), starts(1, 0) {
+        fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd >= 0)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        const edgeindextype perBlock = std::max<edgeindextype>(1, blockBytes / sizeof(nodeindextype));
+        for(nodeindextype u = 0; u < n; u++)
+            if(u > starts.back() && offsets[u + 1] - offsets[starts.back()] > perBlock)
+                starts.push_back(u);
+        if(n > 0)
+            starts.push_back(n);
+    }
+
+    ~EdgeScanner() {
+        if(fd >= 0)
+            ::close(fd);
+    }
+
+    EdgeScanner(const EdgeScanner &) = delete;
+    EdgeScanner & operator=(const EdgeScanner &) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+    nodeindextype blocks() const { return starts.size() - 1; }
+
+    // the block holding the out-list of node u
+    nodeindextype blockOf(const nodeindextype u) const {
+        return std::upper_bound(starts.begin(), starts.end(), u) - starts.begin() - 1;
+    }
+
+    // call visit(u, begin, end) with the out-list [begin, end) of every node u
+    // in the blocks k with active[k], in increasing order of u. throws a
+    // runtime_error if the file cannot be read
+    template <typename Visit>
+    void scan(const std::vector<bool> & active, Visit visit) const {
+        struct Block {
+            nodeindextype k;
+            std::vector<nodeindextype> targets;
+        };
+        BoundedQueue<Block> queue(2);
+        bool failed = false;
+
+        std::thread reader([&]() {
+            for(nodeindextype k = 0; k < blocks() && !failed; k++) {
+                if(!active[k])
+                    continue;
+                Block block{k, std::vector<nodeindextype>(offsets[starts[k + 1]] - offsets[starts[k]])};
+                failed = !readAt(reinterpret_cast<char *>(block.targets.data()),
+                        block.targets.size() * sizeof(nodeindextype),
+                        targetsAt + offsets[starts[k]] * sizeof(nodeindextype));
+                if(failed || !queue.push(std::move(block)))
+                    break;
+            }
+            queue.close();
+        });
+
+        Block block;
+        while(queue.pop(block)) {
+            const nodeindextype * targets = block.targets.data();
+            const edgeindextype first = offsets[starts[block.k]];
+            for(nodeindextype u = starts[block.k]; u < starts[block.k + 1]; u++)
+                visit(u, targets + (offsets[u] - first), targets + (offsets[u + 1] - first));
+        }
+        reader.join();
+        if(failed)
+            throw std::runtime_error("the adjacency lists could not be read from the snapshot");
+    }
+
+  private:
+    int fd;
+    size_t targetsAt; // byte offset of the targets section
+    const edgeindextype * offsets; // start of the out-list of each node
+    std::vector<nodeindextype> starts; // first node of each block, and n
+
+    // read exactly bytes bytes at position at
+    bool readAt(char * buffer, size_t bytes, size_t at) const {
+        while(bytes > 0) {
+            const ssize_t got = pread(fd, buffer, bytes, at);
+            if(got < 0 && errno == EINTR)
+                continue;
+            if(got <= 0)
+                return false;
+            buffer += got;
+            bytes -= got;
+            at += got;
+        }
+        return true;
+    }
+};
+
+}
@@ -6,14 +6,27 @@
 
 #include <teexgraph/Graph.h>
 
+#include "BlockSource.h"
+#include "DistanceIndex.h"
+#include "EdgeListParser.h"
+#include "MappedFile.h"
+#include "Random.h"
+#include "StreamParser.h"
+#include "Workspace.h"
+
+#include <dirent.h>
+#include <glob.h>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <sys/stat.h>
+#include <type_traits>
 #include <vector>
 
 using namespace std;
 using namespace teexgraph;
 
 Graph::Graph(const std::string& filename, const bool directed){
-    maxn = MAXN;
     clear();
     if(directed){
         loadDirected(filename);
@@ -24,25 +37,28 @@ Graph::Graph(const std::string& filename, const bool directed){
 
 // initialization of Graph object
 Graph::Graph() {
-    maxn = MAXN;
     clear();
 } // Graph constructor
 
-// initialization of Graph object
-Graph::Graph(const int nmax) {
+// initialization of Graph object; node storage is sized from the loaded data,
+// so the expected node count is only checked for compatibility
+Graph::Graph(const nodeindextype nmax) {
     assert(nmax > 0);
-    maxn = nmax;
     clear();
 } // Graph constructor
 
 // erase the current Graph object
 void Graph::clear() {
-    nodeMapping.clear();
-    revMapping.clear();
-    E.assign(maxn, vector<int>(0));
-    rE.assign(maxn, vector<int>(0));
-    hasSelfLoop.assign(maxn, false);
-    n = m = selfm = nexti = 0;
+    nodeMapping = make_shared<const NodeMapping<nodeidtype> >();
+    names = make_shared<const StringPool>();
+    stringIds = false;
+    E.clear();
+    rE.clear();
+    snapshot.reset();
+    scanner.reset();
+    labels.reset();
+    n = m = selfm = 0;
+    hasSelfLoop.assign(n, false);
     loaded = sortedandunique = undirected = doneWCC = doneSCC = false;
     largestWCC = wccs = largestSCC = sccs = 0;
     wccId.assign(n, 0);
@@ -54,74 +70,331 @@ void Graph::clear() {
 } // clear
 
 
-// map input file node node number to id in range [0,n-1]
-int Graph::mapNode(const nodeidtype i) {
-    if(nodeMapping.find(i) == nodeMapping.end()) {
-        nodeMapping[i] = nexti;
-        revMapping[nexti] = i;
-        nexti++;
-    } // if
-    return nodeMapping[i];
+// map input file node number to id in range [0,n-1]; -1 if it is not in the graph
+nodeindextype Graph::mapNode(const nodeidtype i) const {
+    return nodeMapping->find(i);
+} // mapNode
+
+
+// map a node identifier given as text, such as a string identifier; -1 if it
+// is not in the graph
+nodeindextype Graph::mapNode(const string & identifier) const {
+    if(stringIds)
+        return names->find(identifier);
+    nodeidtype i;
+    const char * end = identifier.data() + identifier.size();
+    if(scanInteger(identifier.data(), end, i) != end)
+        return -1;
+    return nodeMapping->find(i);
 } // mapNode
 
 
 // reverse map node id to original node number
-nodeidtype Graph::revMapNode(const int i) const {
-    return revMapping.at(i);
+nodeidtype Graph::revMapNode(const nodeindextype i) const {
+    if(stringIds)
+        throw logic_error("the graph has string node identifiers; use nodeName() instead");
+    return nodeMapping->at(i);
 } // revMapNode
 
 
-// add an edge to the graph and update the necessary statistics
-bool Graph::addEdge(const int u, const int v) {
+// original node identifier of node id i as text, for both integer and string identifiers
+string Graph::nodeName(const nodeindextype i) const {
+    if(stringIds)
+        return names->at(i);
+    return to_string(nodeMapping->at(i));
+} // nodeName
+
 
-    // check if node is within bounds set in Graph.h
-    if(u < 0 || u >= maxn || v < 0 || v >= maxn) {
+// load an undirected graph from a file in edge list format: [u v]
+bool Graph::loadUndirected(const string filename, const IdMapping mapping) {
+    if(!loadDirected(filename, mapping))
         return false;
+    makeUndirected();
+    return true;
+} // loadUndirected
+
+
+// parse an in-memory edge list in parallel, see EdgeListParser.h
+template <typename Id>
+static vector< vector<Id> > parseEdgeText(const char * data, const size_t size) {
+    const char * begin = data + skipHeader(data, size);
+    const char * end = data + size;
+    const char * stoppedAt;
+    vector< vector<Id> > buffers = parseEdgeList<Id>(begin, end, stoppedAt);
+    if(stoppedAt != end)
+        clog << "- Stopped reading at byte " << (stoppedAt - data)
+                << ", which does not contain an edge." << endl;
+    return buffers;
+} // parseEdgeText
+
+
+// parse a memory-mapped edge list in parallel
+template <typename Id>
+static vector< vector<Id> > parseMappedEdgeList(const MappedFile & file, true_type) {
+    return parseEdgeText<Id>(file.data(), file.size());
+} // parseMappedEdgeList
+
+
+// the hand-rolled number scanner only handles integer node identifiers
+template <typename Id>
+static vector< vector<Id> > parseMappedEdgeList(const MappedFile &, false_type) {
+    return vector< vector<Id> >();
+} // parseMappedEdgeList
+
+
+// read an edge list [u v] edge by edge with >>; for non-integer node identifiers
+template <typename Id>
+static void readEdgeStream(istream & in, vector<Id> & buffer) {
+    Id u, v;
+
+	// peek at first line
+    char c = in.peek();
+
+    // ignore any whitespace or newlines at the beginning of the file
+    while(c == '\n' || c == '\r' || c == '\t' || c == ' ') {
+        c = in.get();        
+        c = in.peek();    
+    }
+    
+    // ignore first lines that do not start with an alphanumeric character; 
+    // first line(s) might contain graph meta information in some formats
+    while(in.good() && !isAlphanumeric(c)) {
+        do {
+            c = in.get();
+        } while(in.good() && c != '\n');
+        c = in.peek();
     }
 
-    // note if it is a self-loop
-    if(u == v) {
-        selfm++;
-        hasSelfLoop[u] = true;
+    // now we assume to have gotten rid of all meta data in the beginning of the file
+
+    // load the edge list
+    while(in >> u >> v) {
+        if(buffer.size() % 20000000 == 0 && !buffer.empty())
+            clog << "   - " << buffer.size() / 2 << " edges loaded so far..." << endl;
+        buffer.push_back(u);
+        buffer.push_back(v);
     }
+} // readEdgeStream
 
-    // increment edge count
-    m++;
 
-    // increment node count if one of the two nodes is first seen
-    if(rE[v].size() == 0 && E[v].size() == 0) {
-        n++;
+// read blocks on a separate thread while parsing them in parallel, see StreamParser.h
+template <typename Id>
+static bool parseEdgeSource(BlockSource & source, vector< vector<Id> > & buffers, true_type) {
+    long stoppedAt;
+    if(!parseEdgeStream<Id>(source, buffers, stoppedAt))
+        return false;
+    if(stoppedAt >= 0)
+        clog << "- Stopped reading at byte " << stoppedAt
+                << " of the input, which does not contain an edge." << endl;
+    return true;
+} // parseEdgeSource
+
+
+// other node identifiers are read with >>
+template <typename Id>
+static bool parseEdgeSource(BlockSource & source, vector< vector<Id> > & buffers, false_type) {
+    BlockStreamBuf streamBuf(source);
+    istream in(&streamBuf);
+    buffers.assign(1, vector<Id>());
+    readEdgeStream(in, buffers[0]);
+    return !streamBuf.failed();
+} // parseEdgeSource
+
+
+// read an edge list from a file, pipe or stream that is not memory-mapped,
+// decompressing it if needed
+template <typename Id>
+static bool readEdgeSource(BlockSource * source, const Compression compression, const string & error,
+        vector< vector<Id> > & buffers) {
+    if(source == nullptr) {
+        cerr << "Error: " << error << endl;
+        return false;
+    }
+    if(compression != Compression::NONE)
+        clog << "- Decompressing " << compressionName(compression) << " input..." << endl;
+    clog << "- Parsing blocks with " << omp_get_max_threads() << " threads..." << endl;
+    if(!parseEdgeSource<Id>(*source, buffers, is_integral<Id>())) {
+        cerr << "Error: the input could not be read";
+        if(compression != Compression::NONE)
+            cerr << " or is not valid " << compressionName(compression) << " data";
+        cerr << "." << endl;
+        return false;
     }
-    if(v != u && rE[u].size() == 0 && E[u].size() == 0) {
-        n++;
+    return true;
+} // readEdgeSource
+
+
+// read all of a block source into text; false if it could not be read
+static bool readAll(BlockSource & source, vector<char> & text) {
+    const size_t blockSize = 1 << 22;
+    long got;
+    do {
+        const size_t have = text.size();
+        text.resize(have + blockSize);
+        got = source.read(text.data() + have, blockSize);
+        text.resize(have + max(got, 0L));
+    } while(got > 0);
+    return got == 0;
+} // readAll
+
+
+// read an edge list with string identifiers from a file, pipe or stream that
+// is not memory-mapped. the tokens point into the input, so all of it is read
+// into text first and then parsed in parallel
+static bool readStringSource(BlockSource * source, const Compression compression, const string & error,
+        vector<char> & text, vector< vector<StringToken> > & tokens) {
+    if(source == nullptr) {
+        cerr << "Error: " << error << endl;
+        return false;
+    }
+    if(compression != Compression::NONE)
+        clog << "- Decompressing " << compressionName(compression) << " input..." << endl;
+    if(!readAll(*source, text)) {
+        cerr << "Error: the input could not be read";
+        if(compression != Compression::NONE)
+            cerr << " or is not valid " << compressionName(compression) << " data";
+        cerr << "." << endl;
+        return false;
     }
+    clog << "- Parsing with " << omp_get_max_threads() << " threads..." << endl;
+    tokens = parseEdgeText<StringToken>(text.data(), text.size());
+    return true;
+} // readStringSource
+
+
+// the files of an edge list that is split in shards: the files in a directory
+// other than hidden and marker files such as _SUCCESS, or the files matching a
+// glob pattern, in sorted order. returns false if filename is a single file
+static bool shardFiles(const string & filename, vector<string> & files) {
+    struct stat info;
+    if(stat(filename.c_str(), &info) == 0) {
+        if(!S_ISDIR(info.st_mode))
+            return false;
+        DIR * dir = opendir(filename.c_str());
+        if(dir == nullptr)
+            return true;
+        for(const dirent * entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+            const string name = entry->d_name;
+            const string path = filename + "/" + name;
+            if(name[0] != '.' && name[0] != '_' && stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+                files.push_back(path);
+        }
+        closedir(dir);
+        sort(files.begin(), files.end());
+        return true;
+    }
+    if(filename.find_first_of("*?[") == string::npos)
+        return false;
+    glob_t matches;
+    if(glob(filename.c_str(), 0, nullptr, &matches) == 0)
+        for(size_t i = 0; i < matches.gl_pathc; i++)
+            if(stat(matches.gl_pathv[i], &info) == 0 && S_ISREG(info.st_mode))
+                files.push_back(matches.gl_pathv[i]);
+    globfree(&matches);
+    return true;
+} // shardFiles
 
-    E[u].push_back(v);
-    rE[v].push_back(u);
 
-    sortedandunique = false;
-    undirected = false;
-    doneWCC = false;
-    doneSCC = false;
-    return true;
-} // addEdge
+// parse an in-memory shard; stoppedAt is the byte at which parsing stopped, or -1
+template <typename Id>
+static void parseShardText(const char * data, const size_t size, vector< vector<Id> > & buffers,
+        long & stoppedAt) {
+    const char * end = data + size;
+    const char * stop;
+    buffers = parseEdgeList<Id>(data + skipHeader(data, size), end, stop);
+    stoppedAt = (stop == end) ? -1 : stop - data;
+} // parseShardText
 
 
-// load an undirected graph from a file in edge list format: [u v]
-bool Graph::loadUndirected(const string filename) {
-    if(!loadDirected(filename))
+// integer identifiers of a compressed shard are parsed while it is decompressed
+template <typename Id>
+static bool parseShardSource(BlockSource & source, vector<char> &, vector< vector<Id> > & buffers,
+        long & stoppedAt, true_type) {
+    return parseEdgeStream<Id>(source, buffers, stoppedAt);
+} // parseShardSource
+
+
+// string identifiers point into the input, so the shard is decompressed into text first
+template <typename Id>
+static bool parseShardSource(BlockSource & source, vector<char> & text, vector< vector<Id> > & buffers,
+        long & stoppedAt, false_type) {
+    if(!readAll(source, text))
         return false;
-    makeUndirected();
+    parseShardText(text.data(), text.size(), buffers, stoppedAt);
     return true;
-} // loadUndirected
+} // parseShardSource
+
+
+// parse all shards into one list of buffers, in the order of the files. with
+// at least as many shards as threads, every thread parses whole shards, which
+// keeps many files in flight at once; fewer shards are parsed one by one with
+// all threads each. mapped and texts keep the input of string identifiers alive
+template <typename Id>
+static bool readShards(const vector<string> & files, vector<MappedFile> & mapped, vector< vector<char> > & texts,
+        vector< vector<Id> > & buffers) {
+    const int shards = files.size();
+    vector< vector< vector<Id> > > shardBuffers(shards);
+    vector<long> stops(shards, -1);
+    vector<string> errors(shards);
+
+#pragma omp parallel for schedule(dynamic, 1) if(shards >= omp_get_max_threads())
+    for(int i = 0; i < shards; i++) {
+        if(mapped[i].open(files[i]) &&
+                detectCompression(reinterpret_cast<const unsigned char *>(mapped[i].data()), mapped[i].size()) == Compression::NONE) {
+            parseShardText(mapped[i].data(), mapped[i].size(), shardBuffers[i], stops[i]);
+            if(is_integral<Id>::value)
+                mapped[i].close();
+            continue;
+        }
+        mapped[i].close();
+        Compression compression;
+        unique_ptr<BlockSource> source = openBlockSource(files[i], compression, errors[i]);
+        if(source != nullptr && !parseShardSource<Id>(*source, texts[i], shardBuffers[i], stops[i], is_integral<Id>()))
+            errors[i] = "file " + files[i] + " could not be read" + (compression == Compression::NONE ? "" :
+                    " or is not valid " + compressionName(compression) + " data") + ".";
+    }
 
+    bool ok = true;
+    for(int i = 0; i < shards; i++) {
+        if(!errors[i].empty()) {
+            cerr << "Error: " << errors[i] << endl;
+            ok = false;
+        } else if(stops[i] >= 0)
+            clog << "- Stopped reading " << files[i] << " at byte " << stops[i]
+                    << ", which does not contain an edge." << endl;
+        for(size_t j = 0; j < shardBuffers[i].size(); j++)
+            buffers.push_back(move(shardBuffers[i][j]));
+    }
+    return ok;
+} // readShards
+
+
+// load an edge list that is split in shards, see shardFiles(). the shards are
+// parsed in parallel, after which the identifiers of all shards are mapped at
+// once, so that node ids are consistent across shards
+bool Graph::loadShards(const vector<string> & files, const IdMapping mapping) {
+    if(files.empty()) {
+        cerr << "Error: no edge list files found." << endl;
+        return false;
+    }
+    clog << "- Parsing " << files.size() << " shards with " << omp_get_max_threads() << " threads..." << endl;
+    vector<MappedFile> mapped(files.size());
+    vector< vector<char> > texts(files.size());
+    if(mapping == IdMapping::STRING) {
+        vector< vector<StringToken> > tokens;
+        return readShards(files, mapped, texts, tokens) && loadStringTokens(tokens);
+    }
+    vector< vector<nodeidtype> > buffers;
+    if(!readShards(files, mapped, texts, buffers))
+        return false;
+    return loadEdgeBuffers(buffers, mapping);
+} // loadShards
 
-// load a graph from a file in edge list format: [u v]
-bool Graph::loadDirected(const string filename) {
-    nodeidtype u, v;
-    long edgesAdded = 0, edgesSkipped = 0;
-    ifstream fin;
 
+// load a graph from a file in edge list format: [u v], optionally compressed
+// with gzip, bzip2 or zstd; "-" reads standard input. a directory or glob
+// pattern loads all its files as shards of one edge list
+bool Graph::loadDirected(const string filename, const IdMapping mapping) {
     clog << endl << "Loading graph from " << filename << " ..." << endl;
 
     // check if not already loaded
@@ -130,51 +403,120 @@ bool Graph::loadDirected(const string filename) {
         return false;
     }
 
-    // load the file
-    fin.open(filename.c_str());
-    if(!fin.is_open()) {
-        cerr << "Error: file " << filename << " not found." << endl;
-        return false;
+    vector<string> files;
+    if(shardFiles(filename, files))
+        return loadShards(files, mapping);
+
+    // uncompressed regular files are mapped in memory and parsed in parallel
+    vector< vector<nodeidtype> > buffers;
+    MappedFile file;
+    if(is_integral<nodeidtype>::value && file.open(filename) &&
+            detectCompression(reinterpret_cast<const unsigned char *>(file.data()), file.size()) == Compression::NONE) {
+        clog << "- Parsing with " << omp_get_max_threads() << " threads..." << endl;
+        if(mapping == IdMapping::STRING) { // the tokens point into the mapped file
+            const bool result = loadStringTokens(parseMappedEdgeList<StringToken>(file, true_type()));
+            file.close();
+            return result;
+        }
+        buffers = parseMappedEdgeList<nodeidtype>(file, is_integral<nodeidtype>());
+        file.close();
+        return loadEdgeBuffers(buffers, mapping);
+    }
+    file.close();
+
+    // everything else is read in blocks
+    Compression compression;
+    string error;
+    unique_ptr<BlockSource> source = openBlockSource(filename, compression, error);
+    if(mapping == IdMapping::STRING) {
+        vector<char> text;
+        vector< vector<StringToken> > tokens;
+        return readStringSource(source.get(), compression, error, text, tokens) && loadStringTokens(tokens);
     }
+    if(!readEdgeSource(source.get(), compression, error, buffers))
+        return false;
+    return loadEdgeBuffers(buffers, mapping);
+} // loadDirected
 
 
-	// peek at first line
-    char c = fin.peek();
+// load a graph in edge list format from a file descriptor, such as a pipe
+bool Graph::loadDirectedFromFd(const int fd, const IdMapping mapping) {
+    clog << endl << "Loading graph from file descriptor " << fd << " ..." << endl;
+    if(loaded) {
+        cerr << "Error: a graph is already loaded. Clear it first." << endl;
+        return false;
+    }
+    Compression compression;
+    string error;
+    unique_ptr<BlockSource> source = openBlockSource(fd, false, compression, error);
+    if(mapping == IdMapping::STRING) {
+        vector<char> text;
+        vector< vector<StringToken> > tokens;
+        return readStringSource(source.get(), compression, error, text, tokens) && loadStringTokens(tokens);
+    }
+    vector< vector<nodeidtype> > buffers;
+    if(!readEdgeSource(source.get(), compression, error, buffers))
+        return false;
+    return loadEdgeBuffers(buffers, mapping);
+} // loadDirectedFromFd
 
-    // ignore any whitespace or newlines at the beginning of the file
-    while(c == '\n' || c == '\r' || c == '\t' || c == ' ') {
-        c = fin.get();        
-        c = fin.peek();    
+
+// load a graph in edge list format from an input stream
+bool Graph::loadDirectedFromStream(istream & in, const IdMapping mapping) {
+    clog << endl << "Loading graph from input stream ..." << endl;
+    if(loaded) {
+        cerr << "Error: a graph is already loaded. Clear it first." << endl;
+        return false;
     }
-    
-    // ignore first lines that do not start with an alphanumeric character; 
-    // first line(s) might contain graph meta information in some formats
-    while(!(
-            (c >= '0' && c <= '9') ||
-            (c >= 'a' && c <= 'z') ||
-            (c >= 'A' && c <= 'Z')
-            )) {
-        while(c != '\n')
-            c = fin.get();
-        c = fin.peek();
+    Compression compression;
+    string error;
+    unique_ptr<BlockSource> source = openBlockSource(in, compression, error);
+    if(mapping == IdMapping::STRING) {
+        vector<char> text;
+        vector< vector<StringToken> > tokens;
+        return readStringSource(source.get(), compression, error, text, tokens) && loadStringTokens(tokens);
     }
+    vector< vector<nodeidtype> > buffers;
+    if(!readEdgeSource(source.get(), compression, error, buffers))
+        return false;
+    return loadEdgeBuffers(buffers, mapping);
+} // loadDirectedFromStream
 
-    // now we assume to have gotten rid of all meta data in the beginning of the file
 
-    // load the edge list
-    while(fin >> u >> v) {
-        if(m % 10000000 == 0 && m != 0)
-            clog << "   - " << m << " edges loaded so far..." << endl;
-        if(addEdge(mapNode(u), mapNode(v)))
-            edgesAdded++;
-        else
-            edgesSkipped++;
+// build the graph from parsed edge buffers and report on it
+bool Graph::loadEdgeBuffers(vector< vector<nodeidtype> > & buffers, const IdMapping mapping) {
+    long edgesAdded = 0, edgesSkipped = 0;
+    addEdgeBuffers(buffers, mapping, edgesAdded, edgesSkipped);
+    return finishLoading(edgesAdded, edgesSkipped);
+} // loadEdgeBuffers
+
+
+// intern parsed string identifiers (see StringPool.h), build the graph from
+// the resulting node ids and report on it
+bool Graph::loadStringTokens(const vector< vector<StringToken> > & tokens) {
+    long edgesAdded = 0, edgesSkipped = 0;
+    vector< vector<nodeindextype> > buffers;
+    const shared_ptr<StringPool> pool = make_shared<StringPool>();
+    try {
+        buffers = pool->internTokens(tokens);
+    } catch(const overflow_error & e) {
+        cerr << "Error: " << e.what() << endl;
+        for(size_t i = 0; i < tokens.size(); i++)
+            edgesSkipped += tokens[i].size() / 2;
+        return finishLoading(edgesAdded, edgesSkipped);
     }
+    names = pool;
+    stringIds = true;
+    clog << "- " << names->size() << " nodes, string identifiers interned" << endl;
+    buildEdges(buffers, names->size(), edgesAdded, edgesSkipped);
+    return finishLoading(edgesAdded, edgesSkipped);
+} // loadStringTokens
+
 
+// report on the loaded edges; the graph is cleared if edges were skipped
+bool Graph::finishLoading(const long edgesAdded, const long edgesSkipped) {
     clog << "- " << edgesAdded << " edges added (m = " << m << ") in total\n- "
             << edgesSkipped << " edges skipped" << endl;
-    if(edgesSkipped - selfm > 0)
-        clog << " (out-of-bounds, increase maxn in Graph.h!)";
     clog << "- " << selfm << " self-edges added" << endl;
     clog << endl;
 
@@ -189,19 +531,89 @@ bool Graph::loadDirected(const string filename) {
     cerr << "Loading failed." << endl << endl;
     clear();
     return false;
-} // loadDirected
+} // finishLoading
+
+
+// map buffers of [u v u v ...] node identifiers and build the adjacency lists
+// from them; buffers are overwritten with the mapped node ids
+void Graph::addEdgeBuffers(vector< vector<nodeidtype> > & buffers, const IdMapping mapping,
+        long & edgesAdded, long & edgesSkipped) {
+    const shared_ptr< NodeMapping<nodeidtype> > built = make_shared< NodeMapping<nodeidtype> >();
+    if(!built->mapEdges(buffers, mapping)) {
+        for(size_t i = 0; i < buffers.size(); i++)
+            edgesSkipped += buffers[i].size() / 2;
+        return;
+    }
+    nodeMapping = built;
+    clog << "- " << nodeMapping->size() << " nodes, "
+            << (nodeMapping->isDense() ? "identifiers used as node ids" : "identifiers renumbered") << endl;
+    buildEdges(buffers, nodeMapping->size(), edgesAdded, edgesSkipped);
+} // addEdgeBuffers
+
+
+// build the adjacency lists of nodecount nodes from buffers of [u v u v ...]
+// node ids
+template <typename Id>
+void Graph::buildEdges(const vector< vector<Id> > & buffers, const nodeindextype nodecount,
+        long & edgesAdded, long & edgesSkipped) {
+    const int chunks = buffers.size();
+    size_t total = 0;
+    for(int i = 0; i < chunks; i++)
+        total += buffers[i].size() / 2;
+    if(total > (size_t) numeric_limits<edgeindextype>::max()) {
+        cerr << "Error: more than " << numeric_limits<edgeindextype>::max() << " edges; build with 64-bit "
+                << "list positions (without TEEXGRAPH_32BIT_EDGES) to load this graph." << endl;
+        nodeMapping = make_shared<const NodeMapping<nodeidtype> >();
+        names = make_shared<const StringPool>();
+        edgesSkipped += total;
+        return;
+    }
+
+    // out- and in-lists are independent, so build them concurrently
+#pragma omp parallel sections
+    {
+#pragma omp section
+        E.build(nodecount, buffers, false);
+#pragma omp section
+        rE.build(nodecount, buffers, true);
+    }
+
+    hasSelfLoop.assign(nodecount, false);
+    for(int i = 0; i < chunks; i++) {
+        for(size_t j = 0; j < buffers[i].size(); j += 2)
+            if(buffers[i][j] == buffers[i][j + 1]) {
+                selfm++;
+                hasSelfLoop[buffers[i][j]] = true;
+            }
+        edgesAdded += buffers[i].size() / 2;
+    }
+    m += edgesAdded;
+    n = nodecount;
+
+    sortedandunique = false;
+    undirected = false;
+    doneWCC = false;
+    doneSCC = false;
+} // buildEdges
 
 
 // check if there is an edge from a to b - O(log(outdegree(a)))
-bool Graph::edge(const int a, const int b) {
+bool Graph::edge(const nodeindextype a, const nodeindextype b) {
     if(!sortedandunique)
         sortEdgeList();
-    int first = 0, last = E[a].size() - 1, mid;
+    const NodeSpan list = E[a];
+    if(list.isCompressed()) { // no random access, but the list is sorted
+        for(const nodeindextype j : list)
+            if(j >= b)
+                return j == b;
+        return false;
+    }
+    nodeindextype first = 0, last = list.size() - 1, mid;
     while(first <= last) {
         mid = (first + last) / 2;
-        if(b > E[a][mid])
+        if(b > list[mid])
             first = mid + 1;
-        else if(b < E[a][mid])
+        else if(b < list[mid])
             last = mid - 1;
         else
             return true;
@@ -211,9 +623,9 @@ bool Graph::edge(const int a, const int b) {
 
 
 // check if there is an edge from a to b without requiring sortid list - O(outdegree(a))
-bool Graph::edgeSlow(const int a, const int b) {
-    for(size_t j = 0; j < E[a].size(); j++)
-        if(E[a][j] == b)
+bool Graph::edgeSlow(const nodeindextype a, const nodeindextype b) {
+    for(const nodeindextype j : E[a])
+        if(j == b)
             return true;
     return false;
 } // edgeSlow
@@ -222,19 +634,11 @@ bool Graph::edgeSlow(const int a, const int b) {
 // sort edge list so that O(log(outdegree(a))) queries edge(a,b) are possible
 void Graph::sortEdgeList() {
     clog << "Sorting edge list..." << endl;
-    int removed = 0, begin;
     if(!sortedandunique) {
-        m = 0;
-        // TODO: make parallel, atomic m and removed update
-        for(int i = 0; i < n; i++) {
-            sort(E[i].begin(), E[i].end());
-            begin = E[i].size();
-            E[i].erase(unique(E[i].begin(), E[i].end()), E[i].end());
-            sort(rE[i].begin(), rE[i].end());
-            rE[i].erase(unique(rE[i].begin(), rE[i].end()), rE[i].end());
-            m += (long) E[i].size();
-            removed += (E[i].size() - begin);
-        }
+        scanner.reset(); // the lists on disk are outdated
+        const long removed = E.sortUnique();
+        rE.sortUnique();
+        m = E.edges();
 
         sortedandunique = true;
         if(removed > 0)
@@ -245,8 +649,27 @@ void Graph::sortEdgeList() {
 } // sortEdgeList
 
 
+// store the adjacency lists compressed (see Adjacency.h), which typically
+// takes 2-4 times less memory at the cost of decoding them while traversing
+void Graph::compress() {
+    if(E.isCompressed()) {
+        clog << "Adjacency lists are already compressed." << endl;
+        return;
+    }
+    sortEdgeList();
+    clog << "Compressing adjacency lists..." << endl;
+    const size_t before = E.memoryBytes() + rE.memoryBytes();
+    E.compress();
+    rE.compress();
+    snapshot.reset(); // no longer read from
+    scanner.reset();
+    clog << "- From " << before / 1048576 << " MB to " << (E.memoryBytes() + rE.memoryBytes()) / 1048576
+            << " MB" << endl << "Compressing done." << endl;
+} // compress
+
+
 // check if node is in particular scope
-bool Graph::inScope(const int u, const Scope scope) const {
+bool Graph::inScope(const nodeindextype u, const Scope scope) const {
     return
     (scope == Scope::FULL ||
             (scope == Scope::LWCC && doneWCC && wccId[u] == largestWCC) ||
@@ -255,7 +678,7 @@ bool Graph::inScope(const int u, const Scope scope) const {
 
 
 // Get the number of nodes n
-int Graph::nodes(const Scope scope = Scope::FULL) const {
+nodeindextype Graph::nodes(const Scope scope = Scope::FULL) const {
     if(scope == Scope::FULL) {
         return n;
     } else if(scope == Scope::LWCC && doneWCC) {
@@ -267,14 +690,14 @@ int Graph::nodes(const Scope scope = Scope::FULL) const {
 } // nodes
 
 // Get the number of nodes in particular WCC
-int Graph::nodesInWcc(const int WCCId) const {
+nodeindextype Graph::nodesInWcc(const nodeindextype WCCId) const {
     if(doneWCC)
         return wccNodes[WCCId];
     return -1;
 } // nodes
 
 // Get the number of nodes in particular WCC
-int Graph::wccOf(const int u) const {
+nodeindextype Graph::wccOf(const nodeindextype u) const {
     if(doneWCC)
         return wccId[u];
     return -1;
@@ -298,14 +721,14 @@ long Graph::selfEdges(const Scope scope = Scope::FULL) const {
     if(scope == Scope::FULL)
         return selfm;
     else if(scope == Scope::LWCC && doneWCC) {
-        int total = 0;
-        for(int i = 0; i < n; i++)
+        long total = 0;
+        for(nodeindextype i = 0; i < n; i++)
             if(inScope(i, scope) && hasSelfLoop[i])
                 total++;
         return total;
     } else if(scope == Scope::LSCC && doneSCC) {
-        int total = 0;
-        for(int i = 0; i < n; i++)
+        long total = 0;
+        for(nodeindextype i = 0; i < n; i++)
             if(inScope(i, scope) && hasSelfLoop[i])
                 total++;
         return total;
@@ -316,7 +739,7 @@ long Graph::selfEdges(const Scope scope = Scope::FULL) const {
 
 // make graph undirected (i.e., if (u,v) and !(v,u), then add (u,v))
 void Graph::makeUndirected() {
-    int z, oldm = m;
+    long oldm = m;
 
     if(undirected) {
         clog << "Graph is already undirected." << endl;
@@ -325,17 +748,18 @@ void Graph::makeUndirected() {
 
     clog << "Making graph undirected (m = " << m << ")..." << endl;
 
-    // add all links
-    sortedandunique = false;
+    // merge the sorted out- and in-lists of every node; this adds all links
+    // without introducing duplicates
+    const bool compressed = E.isCompressed();
+    sortEdgeList();
+    scanner.reset(); // the lists on disk are outdated
+    labels.reset();
+    E.unite(rE);
+    rE.empty(n);
+    if(compressed)
+        E.compress();
+    m = E.edges();
 
-    for(int i = 0; i < n; i++) {
-        z = E[i].size();
-        for(int j = 0; j < z; j++)
-            E[E[i][j]].push_back(i);
-        rE[i].clear();
-    } // for
-
-    sortEdgeList(); // needed to remove duplicates introduced in previous step
     doneWCC = doneSCC = false;
     undirected = true;
     if(m != oldm && m != oldm * 2) {
@@ -351,47 +775,49 @@ void Graph::computeWCC() {
 
     if(m < 1)
         return;
+    if(scanner) {
+        computeWCCExternal();
+        return;
+    }
 
     wccId.assign(n, 0);
     wccNodes.assign(n, 0);
     wccEdges.assign(n, 0);
     largestWCC = wccs = 0;
 
-    int c, current, z;
-    queue<int> q;
+    nodeindextype c, current;
+    queue<nodeindextype> q;
     c = 1;
 
-    for(int i = 0; i < n; i++) {
+    for(nodeindextype i = 0; i < n; i++) {
         if(wccId[i] > 0)
             continue;
         while(!q.empty())
             q.pop();
         wccId[i] = c;
         wccNodes[c]++;
-        wccEdges[c] += (long) E[i].size() + (long) rE[i].size();
+        wccEdges[c] += (long) E.degree(i) + (long) rE.degree(i);
         q.push(i);
         while(!q.empty()) {
             current = q.front();
             q.pop();
-            z = E[current].size();
-            for(int i = 0; i < z; i++) {
-                if(wccId[E[current][i]] == 0) {
-                    wccId[E[current][i]] = c;
+            E.forEach(current, [&](const nodeindextype w) {
+                if(wccId[w] == 0) {
+                    wccId[w] = c;
                     wccNodes[c]++;
-                    wccEdges[c] += (long) E[E[current][i]].size() + (long) rE[E[current][i]].size();
-                    q.push(E[current][i]);
+                    wccEdges[c] += (long) E.degree(w) + (long) rE.degree(w);
+                    q.push(w);
                 }
-            }
+            });
             if(!undirected) {
-                z = rE[current].size();
-                for(int i = 0; i < z; i++) {
-                    if(wccId[rE[current][i]] == 0) {
-                        wccId[rE[current][i]] = c;
+                rE.forEach(current, [&](const nodeindextype w) {
+                    if(wccId[w] == 0) {
+                        wccId[w] = c;
                         wccNodes[c]++;
-                        wccEdges[c] += (long) E[rE[current][i]].size() + (long) rE[rE[current][i]].size();
-                        q.push(rE[current][i]);
+                        wccEdges[c] += (long) E.degree(w) + (long) rE.degree(w);
+                        q.push(w);
                     }
-                }
+                });
             }
         }
 
@@ -403,7 +829,7 @@ void Graph::computeWCC() {
 
     // because we count both reversed and normal edges we count edges double
     if(!undirected)
-        for(int i = 0; i < n; i++)
+        for(nodeindextype i = 0; i < n; i++)
             wccEdges[i] /= 2;
 
     wccs = c;
@@ -412,29 +838,26 @@ void Graph::computeWCC() {
 } // computeWCC
 
 
-// helper function for computeSCC(), simulate DFS post-visit marking
-void Graph::goVisitSCC(const int a, vector<bool> & sccVisited,
-        stack<int> & sccStack, vector<int> & parentOf, vector<int> & atIt) {
-
-    int current = a, newcurrent;
-
-    while(current != -1) {
-        if(atIt[current] == (signed)E[current].size()) {
-            sccStack.push(current);
-            atIt[current] = 0;
-            newcurrent = parentOf[current];
-            parentOf[current] = -1;
-            current = newcurrent;
+// helper function for computeSCC(), simulate DFS post-visit marking; the path
+// holds the position in the out-list of every node on the current DFS path
+void Graph::goVisitSCC(const nodeindextype a, vector<bool> & sccVisited, stack<nodeindextype> & sccStack) {
+    struct Visit {
+        nodeindextype node;
+        NodeSpan::iterator at, end;
+    };
+    vector<Visit> path(1, Visit{a, E[a].begin(), E[a].end()});
+
+    while(!path.empty()) {
+        Visit & visit = path.back();
+        if(visit.at == visit.end) {
+            sccStack.push(visit.node);
+            path.pop_back();
         } else {
-            if(!sccVisited[E[current][atIt[current]]]) {
-                newcurrent = E[current][atIt[current]];
-                sccVisited[newcurrent] = true;
-                parentOf[newcurrent] = current;
-                atIt[current]++;
-                current = newcurrent;
-
-            } else {
-                atIt[current]++;
+            const nodeindextype next = *visit.at;
+            ++visit.at;
+            if(!sccVisited[next]) {
+                sccVisited[next] = true;
+                path.push_back(Visit{next, E[next].begin(), E[next].end()});
             }
         }
     }
@@ -443,10 +866,10 @@ void Graph::goVisitSCC(const int a, vector<bool> & sccVisited,
 
 
 // helper function for computeSCC(), simulate DFS using a stack
-void Graph::goMarkSCC(const int x, const int component) {
-    stack<int> markStack;
+void Graph::goMarkSCC(const nodeindextype x, const nodeindextype component) {
+    stack<nodeindextype> markStack;
     markStack.push(x);
-    int current, z;
+    nodeindextype current;
 
     while(!markStack.empty()) {
         current = markStack.top();
@@ -456,11 +879,10 @@ void Graph::goMarkSCC(const int x, const int component) {
         if(!sccId[current]) {
             sccId[current] = component;
             sccNodes[component]++;
-            z = (signed)rE[current].size();
-            for(int i = 0; i < z; i++)
-                if(!sccId[rE[current][i]]) {
-                    markStack.push(rE[current][i]);
-                } else if(sccId[rE[current][i]] == component) {
+            for(const nodeindextype w : rE[current])
+                if(!sccId[w]) {
+                    markStack.push(w);
+                } else if(sccId[w] == component) {
                     sccEdges[component]++;
                 }
         }
@@ -485,15 +907,14 @@ void Graph::computeSCC() {
     largestSCC = sccs = 0;
 
     vector<bool> sccVisited;
-    vector<int> atIt(n, 0), parentOf(n, -1);
     sccVisited.assign(n, false);
-    stack<int> sccStack;
-    int c = 1;
+    stack<nodeindextype> sccStack;
+    nodeindextype c = 1;
 
-    for(int i = 0; i < n; i++)
+    for(nodeindextype i = 0; i < n; i++)
         if(!sccVisited[i] && E[i].size() > 0) {
             sccVisited[i] = true;
-            goVisitSCC(i, sccVisited, sccStack, parentOf, atIt);
+            goVisitSCC(i, sccVisited, sccStack);
         } // if
 
     while(!sccStack.empty()) {
@@ -517,12 +938,11 @@ void Graph::computeSCC() {
 // compute the reciprocity: fraction of links (u,v) that also exist as (v, u)
 double Graph::reciprocity(const Scope scope = Scope::FULL) {
     double total = 0, reci = 0;
-    for(int i = 0; i < n; i++)
+    for(nodeindextype i = 0; i < n; i++)
         if(inScope(i, scope)) {
-            int z = E[i].size();
-            total += z;
-            for(int j = 0; j < z; j++) {
-                if(edge(E[i][j], i))
+            total += E.degree(i);
+            for(const nodeindextype j : E[i]) {
+                if(edge(j, i))
                     reci++;
             } // for
         } // if
@@ -583,7 +1003,7 @@ double Graph::averageDegree(const Scope scope) const {
 
 
 // compute one node's clustering coefficient
-double Graph::nodeClusteringCoefficient(const int u) {
+double Graph::nodeClusteringCoefficient(const nodeindextype u) {
     if((signed)E[u].size() > 1) {
         pair<double long, double long> result = trianglesWedgesAround(u);
         if(result.second > 0)
@@ -594,13 +1014,13 @@ double Graph::nodeClusteringCoefficient(const int u) {
 
 
 // compute/approximate the node clustering coefficient for each node
-vector<double> Graph::localClustering(vector<int> & todo) {
+vector<double> Graph::localClustering(vector<nodeindextype> & todo) {
 
     vector<double> temparray((signed)todo.size(), -1);
     double temp;
 
 #pragma omp parallel for schedule(dynamic, 1) default(none) shared(clog,todo,temparray) private(temp)
-    for(int i = 0; i < (signed)todo.size(); i++) {
+    for(nodeindextype i = 0; i < (signed)todo.size(); i++) {
         if(todo.size() >= 100 && i % ((signed)todo.size() / 20) == 0) // show status % without div by 0 errors
             clog << " " << i / ((signed)todo.size() / 100) << "%";
         temp = nodeClusteringCoefficient(todo[i]);
@@ -611,14 +1031,16 @@ vector<double> Graph::localClustering(vector<int> & todo) {
     return temparray;
 } // localClustering
 
-// compute/approximate the graph's average local clustering coefficient
-double Graph::averageClusteringCoefficient(const Scope scope = Scope::FULL, const double inputsamplesize = 1.0) {
-    int samples = 0;
+// compute/approximate the graph's average local clustering coefficient; the
+// sample is drawn with the given seed
+double Graph::averageClusteringCoefficient(const Scope scope = Scope::FULL, const double inputsamplesize = 1.0,
+        const uint64_t seed) {
+    nodeindextype samples = 0;
     double samplesize = setSampleSize(samples, scope, inputsamplesize); // also modifies samples
-    vector<int> todo = getSample(samples, scope);
+    vector<nodeindextype> todo = getSample(samples, scope, seed);
     vector<double> values = localClustering(todo);
     long double total = 0;
-    for(int i = 0; i < (signed)todo.size(); i++)
+    for(nodeindextype i = 0; i < (signed)todo.size(); i++)
        total += (long double) values[i];
 
     return (total / samplesize) / (long double) nodes(scope);
@@ -629,19 +1051,19 @@ long Graph::triangles(const Scope scope) {
     long grandtotal = 0;
     int tid;
     pair<long, long> result;
-    const int cpus = omp_get_num_procs();
-    vector<long> total(cpus, 0);
+    const int threads = omp_get_max_threads();
+    vector<long> total(threads, 0);
 #pragma omp parallel for schedule(dynamic, 1) shared(clog, scope, total) private(tid, result)
-    for(int i = 0; i < n; i++)
+    for(nodeindextype i = 0; i < n; i++)
         if(inScope(i, scope)) {
-        	if(i % max(1, n / 20) == 0) // show status % without div by 0 errors
-            	clog << " " << i / max(1, n / 100) << "%";
+        	if(i % max<nodeindextype>(1, n / 20) == 0) // show status % without div by 0 errors
+            	clog << " " << i / max<nodeindextype>(1, n / 100) << "%";
         	tid = omp_get_thread_num();
        		result = trianglesWedgesAround(i);
         	total[tid] += result.first;
     	}
     clog << " Done." << endl;
-    for(int i = 0; i < cpus; i++)
+    for(int i = 0; i < threads; i++)
         grandtotal += total[i];
     return grandtotal / 3;
 } // triangles
@@ -652,14 +1074,14 @@ long Graph::wedges(const Scope scope) {
     long grandtotal = 0;
     int tid;
     pair<long, long> result;
-    const int cpus = omp_get_num_procs();
-    vector<long> total(cpus, 0);
+    const int threads = omp_get_max_threads();
+    vector<long> total(threads, 0);
     
 #pragma omp parallel for schedule(dynamic, 1) default(none) shared(clog, scope, total) private(tid, result)
-    for(int i = 0; i < n; i++) {
+    for(nodeindextype i = 0; i < n; i++) {
         if(inScope(i, scope)) {
-        	if(i % max(1, n / 20) == 0) // show status % without div by 0 errors
-            	clog << " " << i / max(1, n / 100) << "%";
+        	if(i % max<nodeindextype>(1, n / 20) == 0) // show status % without div by 0 errors
+            	clog << " " << i / max<nodeindextype>(1, n / 100) << "%";
      		tid = omp_get_thread_num();
      		result = trianglesWedgesAround(i);
      		total[tid] += result.second;
@@ -667,16 +1089,17 @@ long Graph::wedges(const Scope scope) {
     } // for
     
     clog << " Done." << endl;
-    for(int i = 0; i < cpus; i++)
+    for(int i = 0; i < threads; i++)
         grandtotal += total[i];
     return grandtotal;
 } // wedges
 
 
 // compute number of triangles and wedges around a node, ignoring edge direction
-pair<long, long> Graph::trianglesWedgesAround(const int u) {
+pair<long, long> Graph::trianglesWedgesAround(const nodeindextype u) {
     pair<long, long> result;
-    vector<int> templist = E[u];
+    vector<nodeindextype> & templist = Workspace::local().list;
+    templist.assign(E[u].begin(), E[u].end());
 
     // in a directed graph, merge in- and out-neighbors
     if(!undirected) {
@@ -685,11 +1108,11 @@ pair<long, long> Graph::trianglesWedgesAround(const int u) {
         templist.erase(unique(templist.begin(), templist.end()), templist.end());
     }
 
-    const int z = templist.size();
+    const nodeindextype z = templist.size();
     long triangles = 0;
 
-    for(int i = 0; i < z; i++) {
-        for(int j = i + 1; j < z; j++)
+    for(nodeindextype i = 0; i < z; i++) {
+        for(nodeindextype j = i + 1; j < z; j++)
             if((edge(templist[i], templist[j]) || edge(templist[j], templist[i])) &&
                     templist[i] != u &&
                     templist[j] != u &&
@@ -699,7 +1122,7 @@ pair<long, long> Graph::trianglesWedgesAround(const int u) {
     }
 
     result.first = triangles;
-    int wedgePotential = (signed)templist.size();
+    long wedgePotential = templist.size();
     if(hasSelfLoop[u])
         wedgePotential -= 1;
     result.second = (wedgePotential * (wedgePotential - 1)) / 2;
@@ -712,13 +1135,13 @@ double Graph::graphClusteringCoefficient(const Scope scope = Scope::FULL) {
     long double totaltriangles = 0, totalwedges = 0;
     int tid;
     pair<long, long> result;
-    const int cpus = omp_get_num_procs();
-    vector<long double> triangles(cpus, 0);
-    vector<long double> wedges(cpus, 0);
+    const int threads = omp_get_max_threads();
+    vector<long double> triangles(threads, 0);
+    vector<long double> wedges(threads, 0);
 #pragma omp parallel for schedule(dynamic, 1) default(none) shared(clog, scope, triangles, wedges) private(tid, result)
-    for(int i = 0; i < n; i++) {
-        if(i % max(1, n / 20) == 0) // show status % without div by 0 errors
-            clog << " " << i / max(1, n / 100) << "%";
+    for(nodeindextype i = 0; i < n; i++) {
+        if(i % max<nodeindextype>(1, n / 20) == 0) // show status % without div by 0 errors
+            clog << " " << i / max<nodeindextype>(1, n / 100) << "%";
         if(inScope(i, scope)) {
             tid = omp_get_thread_num();
             result = trianglesWedgesAround(i);
@@ -727,7 +1150,7 @@ double Graph::graphClusteringCoefficient(const Scope scope = Scope::FULL) {
         }
     }
     clog << " Done." << endl;
-    for(int i = 0; i < cpus; i++) {
+    for(int i = 0; i < threads; i++) {
         totaltriangles += triangles[i];
         totalwedges += wedges[i];
     }
@@ -736,14 +1159,14 @@ double Graph::graphClusteringCoefficient(const Scope scope = Scope::FULL) {
 
 
 // distribution of weakly connected component sizes
-vector<int> Graph::wccSizeDistribution() {
+vector<nodeindextype> Graph::wccSizeDistribution() {
     //printDistri(wccNodes, LWCC);
     //clog << "WCC size distribution printed." << endl;
 	return wccNodes;
 } // wccSizeDistribution
 
 // distribution of strongly connected component sizes
-vector<int> Graph::sccSizeDistribution() {
+vector<nodeindextype> Graph::sccSizeDistribution() {
     //printDistri(sccNodes, LSCC);
     //clog << "SCC size distribution printed." << endl;
 	return sccNodes;
@@ -751,7 +1174,7 @@ vector<int> Graph::sccSizeDistribution() {
 
 vector<long> Graph::outdegreeDistribution(const Scope scope = Scope::FULL) {
     vector<long> outDeg(n); // outdegrees
-    for(int i = 0; i < n; i++) {
+    for(nodeindextype i = 0; i < n; i++) {
         outDeg[i] = (signed)E[i].size();
     }
     //printDistri(outDeg, scope);
@@ -760,7 +1183,7 @@ vector<long> Graph::outdegreeDistribution(const Scope scope = Scope::FULL) {
 } // outdegreeDistribution
 vector<long> Graph::indegreeDistribution(const Scope scope = Scope::FULL) {
     vector<long> inDeg(n); // indegrees
-    for(int i = 0; i < n; i++) {
+    for(nodeindextype i = 0; i < n; i++) {
         inDeg[i] = (signed)rE[i].size();
     }
     //printDistri(inDeg, scope);
@@ -769,82 +1192,48 @@ vector<long> Graph::indegreeDistribution(const Scope scope = Scope::FULL) {
 } // indegreeDistribution
 
 
-// compute the distance between node u and v --- O(m)
-int Graph::distance(const int u, const int v) const {
-    int current, z;
-    queue<int> q;
-    vector<int> d(n, -1);
-
-    d[u] = 0;
-    q.push(u);
-    while(!q.empty()) {
-        current = q.front();
-        q.pop();
-        z = E[current].size();
-        for(int j = 0; j < z; j++) {
-            if(d[E[current][j]] == -1) {
-                d[E[current][j]] = d[current] + 1;
-                if(E[current][j] == v)
-                    return d[v];
-                q.push(E[current][j]);
-            }
-        }
-    }
-    return d[v];
+// compute the distance between node u and v, or -1 if v cannot be reached
+// from u --- O(m), but usually far less; with a distance index, the time of
+// merging the labels of u and v (see DistanceIndex.cpp)
+nodeindextype Graph::distance(const nodeindextype u, const nodeindextype v) const {
+    if(labels)
+        return labels->distance(u, v);
+    return bidirectionalBfs(u, v);
 } // distance
 
+// compute a shortest path from node u to v, starting with u and ending with v;
+// empty if v cannot be reached from u --- O(m), but usually far less
+vector<nodeindextype> Graph::shortestPath(const nodeindextype u, const nodeindextype v) const {
+    vector<nodeindextype> path;
+    bidirectionalBfs(u, v, &path);
+    return path;
+} // shortestPath
+
 // compute and return all distances from node u --- O(m)
-vector<int> Graph::alldistances(const int u) {
-    int current, z;
-    queue<int> q;
-    vector<int> d(n, -1);
-
-    d[u] = 0;
-    q.push(u);
-    while(!q.empty()) {
-        current = q.front();
-        q.pop();
-        z = E[current].size();
-        for(int j = 0; j < z; j++) {
-            if(d[E[current][j]] == -1) {
-                d[E[current][j]] = d[current] + 1;
-                q.push(E[current][j]);
-            }
-        }
-    }
+vector<nodeindextype> Graph::alldistances(const nodeindextype u) {
+    vector<nodeindextype> d;
+    bfs(u);
+    Workspace::local().distances(d);
     return d;
 } // alldistances
 
 
 // parallel-ready function to compute all distances and update dtotals
-vector<int> Graph::distances(const int u, vector<long> & dtotals) const {
-    int current, z;
-    queue<int> q;
-    vector<int> d(nodes(Scope::FULL), -1);
-
-    d[u] = 0;
-    q.push(u);
-    dtotals[d[u]]++;
-    while(!q.empty()) {
-        current = q.front();
-        q.pop();
-        z = neighbors(current).size();
-        for(int j = 0; j < z; j++) {
-            if(d[neighbors(current)[j]] == -1) {
-                d[neighbors(current)[j]] = d[current] + 1;
-                q.push(neighbors(current)[j]);
-                dtotals[d[neighbors(current)[j]]]++;
-            }
-        }
-    }
+vector<nodeindextype> Graph::distances(const nodeindextype u, vector<long> & dtotals) const {
+    vector<nodeindextype> d;
+    const vector<nodeindextype> levels = bfs(u);
+    for(size_t i = 0; i < levels.size(); i++)
+        dtotals[i] += levels[i];
+    Workspace::local().distances(d);
     return d;
 } // distances
 
 // compute average distance between all node pairs; value makes sense on L(S/W)CC only
-double Graph::averageDistance(const Scope scope = Scope::LWCC, const double inputsamplesize = 1.0) {
+double Graph::averageDistance(const Scope scope = Scope::LWCC, const double inputsamplesize = 1.0,
+        const uint64_t seed) {
     vector<long> result;
     long res = 0;
-    result = distanceDistribution(scope, inputsamplesize);
+    result = distanceDistribution(scope, inputsamplesize, seed);
     for(size_t i = 0; i < result.size(); i++) {
         if(result[i] > 0) {
             res += (long)i * result[i];
@@ -853,55 +1242,65 @@ double Graph::averageDistance(const Scope scope = Scope::LWCC, const double inpu
     return res / (long double) ((long double) nodes(scope) * ((long double) nodes(scope) - 1));
 } // averageDistance
 
-// print the distance distribution [distance frequency]
-vector<long> Graph::distanceDistribution(const Scope scope = Scope::FULL, const double inputsamplesize = 1.0) {
+// print the distance distribution [distance frequency]; sampled sources are
+// drawn with the given seed
+vector<long> Graph::distanceDistribution(const Scope scope = Scope::FULL, const double inputsamplesize = 1.0,
+        const uint64_t seed) {
 
     if(nodes(scope) < 2)
         return vector<long>(1, 0);
     
-    int a;    
-    const int cpus = omp_get_num_procs();
-    int tid, samples = 0;
-    double total = 0;
-    vector< vector<long> > longarray(cpus, vector<long>(n, 0));
+    const int threads = omp_get_max_threads();
+    nodeindextype samples = 0;
 
     double samplesize = setSampleSize(samples, scope, inputsamplesize); // also modifies samples
-    vector<int> todo = getSample(samples, scope);
+    vector<nodeindextype> todo = getSample(samples, scope, seed);
 	
+    if(scanner) {
+        clog << "Computing distance distribution (based on a " << samplesize * 100
+             << "% sample of " << samples << " nodes) from disk..." << endl;
+        const vector<long> counts = distanceCountsExternal(todo);
+        clog << " " << "Done." << endl;
+        vector<long> alllongarray(n, 0);
+        for(nodeindextype i = 0; i < n; i++)
+            alllongarray[i] = (1.0 / samplesize) * (double) counts[i];
+        return alllongarray;
+    }
+
     clog << "Computing distance distribution (based on a " << samplesize * 100
-         << "% sample of " << samples << " nodes) with " << cpus << " CPUs..." << endl;
-
-#pragma omp parallel for schedule(dynamic, 1) default(none) shared(clog, longarray, samples, todo) private(tid, a)
-    for(size_t i=0; i<todo.size(); i++) {
-    	a = todo[i];
-        tid = omp_get_thread_num();
-        if(samples > 100 && i % (samples / 20) == 0) // show status % without div by 0 errors
-            clog << " " << i / (samples / 100) << "%";
-        distances(a, longarray[tid]);
+         << "% sample of " << samples << " nodes) with " << threads << " CPUs..." << endl;
+
+    // 64 sources per BFS, see multiBfs()
+    vector< vector<long> > longarray(threads, vector<long>(n, 0));
+    const size_t batches = (todo.size() + 63) / 64;
+#pragma omp parallel for schedule(dynamic, 1)
+    for(size_t b = 0; b < batches; b++) {
+        if(batches > 20 && b % (batches / 20) == 0) // show status %
+            clog << " " << b * 100 / batches << "%";
+        multiBfs(todo.data() + 64 * b, min<size_t>(64, todo.size() - 64 * b), &longarray[omp_get_thread_num()], nullptr);
     } // for
 
-
     clog << " " << "Done." << endl;
 
     // merge all cpu results
     vector<long> alllongarray(n, 0);
-    for(int i = 0; i < n; i++) {
-        for(int j = 0; j < cpus; j++) {
-            alllongarray[i] += (1.0 / samplesize)*(double) longarray[j][i];
-            total += (i * longarray[j][i]);
-        }
+    for(nodeindextype i = 0; i < n; i++) {
+        long count = 0;
+        for(int j = 0; j < threads; j++)
+            count += longarray[j][i];
+        alllongarray[i] = (1.0 / samplesize) * (double) count;
     }
 
     return alllongarray;
 } // distanceDistribution
 
-// return reference to vector with neighbors of a node
-const vector<int> & Graph::neighbors(const int i) const {
+// return a view on the neighbors of a node
+NodeSpan Graph::neighbors(const nodeindextype i) const {
     return E.at(i);
 } // neighbors
 
-// return reference to vector with reversed neighbors of a node
-const vector<int> & Graph::revNeighbors(const int i) const {
+// return a view on the reversed neighbors of a node
+NodeSpan Graph::revNeighbors(const nodeindextype i) const {
     return rE.at(i);
 } // revNeighbors
 
@@ -921,6 +1320,23 @@ bool Graph::isSortedAndUnique() const {
     return sortedandunique;
 } // isSortedAndUnique
 
+// check if the adjacency lists are compressed
+bool Graph::isCompressed() const {
+    return E.isCompressed();
+} // isCompressed
+
+
+// are traversals streamed from disk (see SemiExternal.cpp)?
+bool Graph::isSemiExternal() const {
+    return scanner != nullptr;
+} // isSemiExternal
+
+
+// were the nodes loaded with string identifiers (IdMapping::STRING)?
+bool Graph::hasStringIds() const {
+    return stringIds;
+} // hasStringIds
+
 // check if graph's wcc is computed
 bool Graph::wccComputed() const {
     return doneWCC;
@@ -932,45 +1348,36 @@ bool Graph::sccComputed() const {
 } // sccComputed
 
 // return number of wccs
-int Graph::wccCount() const {
+nodeindextype Graph::wccCount() const {
     return wccs;
 } // wccCount
 
 // return number of sccs
-int Graph::sccCount() const {
+nodeindextype Graph::sccCount() const {
     return sccs;
 } // sccComputed
 
-// get an array containing a sample of samples nodes
-vector<int> Graph::getSample(const int samples, const Scope scope = Scope::FULL) {
-    vector<bool> done(n+1, false);
-    done[n] = true;
-    vector<int> todo;
-    int a;
-
-    // fill todo array ...
-    if(samples < nodes(scope)) {
-        // ... with samples random node numbers
-        for(int i=0; i<samples; i++) {
-            a = n;
-            while(done[a] || !inScope(a, scope)) {
-                a = rand() % n;
-            } // while
-            todo.push_back(a);
-            done[a] = true;
-        } // for
-    } // if
-    else {
-        // ... with nodes 0 to n-1 that fall within scope
-        for(int i=0; i<n; i++)
-            if(inScope(i, scope)) {
-                todo.push_back(i);
-            } // if
-    } // else
+// get an array containing a uniform sample of samples distinct nodes in
+// scope, or all nodes in scope if there are not more than samples. the sample
+// is a partial Fisher-Yates shuffle of the nodes in scope with a random stream
+// of the given seed (see Random.h), so it only depends on the seed. a negative
+// number of samples (of a scope that is not computed) also gives all nodes
+vector<nodeindextype> Graph::getSample(const nodeindextype samples, const Scope scope, const uint64_t seed) {
+    vector<nodeindextype> todo;
+    for(nodeindextype i = 0; i < n; i++)
+        if(inScope(i, scope))
+            todo.push_back(i);
+
+    if(samples >= 0 && samples < (nodeindextype) todo.size()) {
+        Random random(seed);
+        for(nodeindextype i = 0; i < samples; i++)
+            swap(todo[i], todo[i + random.below(todo.size() - i)]);
+        todo.resize(samples);
+    }
     return todo;
 } // getSample
 
-double Graph::setSampleSize(int & samples, const Scope scope = Scope::FULL, const double inputsamplesize = 1.0) {
+double Graph::setSampleSize(nodeindextype & samples, const Scope scope = Scope::FULL, const double inputsamplesize = 1.0) {
     double samplesize = inputsamplesize;
 
     // this is only retained if samplesze is exactly 1.0
@@ -980,7 +1387,7 @@ double Graph::setSampleSize(int & samples, const Scope scope = Scope::FULL, cons
     if(samplesize < 1.0) {
         samples = (double) nodes(scope) * samplesize;
     } else if(samplesize > 1.0) { // && samplesize < nodes(scope)) {
-        samples = min((int)samplesize,nodes(scope));// catch sample size larger than number of nodes
+        samples = min((nodeindextype)samplesize,nodes(scope));// catch sample size larger than number of nodes
         samplesize = (double) samples / (double) nodes(scope);
     }
 
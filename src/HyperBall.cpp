@@ -0,0 +1,202 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Approximate neighborhood function by HyperBall. See the following papers
+ * for details:
+ *
+ * P. Boldi, M. Rosa and S. Vigna, HyperANF: Approximating the Neighbourhood
+ * Function of Very Large Graphs on a Budget, in Proceedings of the 20th
+ * International Conference on World Wide Web (WWW 2011), pp. 625-634, 2011.
+ * http://dx.doi.org/10.1145/1963405.1963493
+ *
+ * P. Boldi and S. Vigna, In-Core Computation of Geometric Centralities with
+ * HyperBall: A Hundred Billion Nodes and Beyond, in Proceedings of the 2013
+ * IEEE International Conference on Data Mining Workshops, pp. 621-628, 2013.
+ * http://dx.doi.org/10.1109/ICDMW.2013.10
+ *
+ * Every node has a HyperLogLog counter of 2^bits registers, one byte each, that
+ * estimates the number of nodes within distance t of it. Sweep t sets the
+ * counter of each node to the union of its own counter and those of its
+ * out-neighbors, in parallel over the nodes. Only neighbors whose counter
+ * changed in the previous sweep are merged, and the sweeps stop once no
+ * counter changes, so that the number of sweeps is the diameter plus one. The
+ * growth of the estimates gives the number of pairs at distance t, and the
+ * harmonic and closeness centrality of each node. Memory use is two counters
+ * per node; the relative standard error of a single counter is about
+ * 1.04 / sqrt(2^bits), and sums over many counters are far more accurate.
+ */
+
+#include <teexgraph/Graph.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace teexgraph;
+
+namespace {
+
+const int MIN_BITS = 4, MAX_BITS = 16; // counters of 16 to 65536 registers
+
+
+// hash of a node id, as 64 bits that look random
+uint64_t hashNode(const nodeindextype u) {
+    uint64_t x = (uint64_t) u + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+} // hashNode
+
+// HyperLogLog counters of 2^bits registers
+class Counters {
+  public:
+    Counters(const int bits) : bits(bits), registers((size_t) 1 << bits) {
+        const double m = registers;
+        alpha = (registers == 16) ? 0.673 : (registers == 32) ? 0.697 : (registers == 64) ? 0.709 : 0.7213 / (1 + 1.079 / m);
+        for(int r = 0; r < 65; r++)
+            inverse[r] = ldexp(1.0, -r);
+    }
+
+    size_t size() const { return registers; }
+
+    // add node u to counter c
+    void add(uint8_t * c, const nodeindextype u) const {
+        const uint64_t h = hashNode(u), rest = h << bits;
+        const uint8_t rank = (rest == 0) ? 64 - bits + 1 : __builtin_clzll(rest) + 1;
+        c[h >> (64 - bits)] = max(c[h >> (64 - bits)], rank);
+    }
+
+    // merge counter from into counter to; returns whether to changed
+    bool merge(uint8_t * to, const uint8_t * from) const {
+        uint8_t grown = 0;
+        for(size_t j = 0; j < registers; j++) {
+            const uint8_t r = max(to[j], from[j]);
+            grown |= r ^ to[j];
+            to[j] = r;
+        }
+        return grown != 0;
+    }
+
+    // estimated number of nodes added to counter c, using linear counting for
+    // small estimates
+    double estimate(const uint8_t * c) const {
+        double sum = 0;
+        size_t zeros = 0;
+        for(size_t j = 0; j < registers; j++) {
+            sum += inverse[c[j]];
+            zeros += (c[j] == 0);
+        }
+        const double m = registers, e = alpha * m * m / sum;
+        return (e <= 2.5 * m && zeros > 0) ? m * log(m / zeros) : e;
+    }
+
+  private:
+    int bits;
+    size_t registers;
+    double alpha; // bias correction
+    double inverse[65]; // 2^-r
+};
+
+} // namespace
+
+
+// average distance over the pairs of distinct nodes that can reach each other
+double NeighborhoodFunction::averageDistance() const {
+    double total = 0, count = 0;
+    for(size_t t = 1; t < pairs.size(); t++) {
+        total += t * pairs[t];
+        count += pairs[t];
+    }
+    return (count > 0) ? total / count : 0;
+} // averageDistance
+
+
+// the (interpolated) distance within which a fraction of all pairs of nodes
+// that can reach each other lies; 0.9 gives the usual effective diameter
+double NeighborhoodFunction::effectiveDiameter(const double fraction) const {
+    double reachable = 0;
+    for(size_t t = 1; t < pairs.size(); t++)
+        reachable += pairs[t];
+    double within = 0;
+    for(size_t t = 1; t < pairs.size(); t++) {
+        if(pairs[t] > 0 && within + pairs[t] >= fraction * reachable)
+            return (t - 1) + (fraction * reachable - within) / pairs[t];
+        within += pairs[t];
+    }
+    return 0;
+} // effectiveDiameter
+
+
+// estimate the neighborhood function of the nodes in scope, with counters of
+// 2^bits registers (4 to 16 bits): the number of pairs at each distance, the
+// harmonic and closeness centrality of each node (0 for nodes not in scope).
+// distances are along out-links --- O(m) per sweep, one sweep per distance
+NeighborhoodFunction Graph::hyperBall(const Scope scope, const int bits) const {
+    NeighborhoodFunction result;
+    if(nodes(scope) < 2 || bits < MIN_BITS || bits > MAX_BITS) {
+        cerr << "Error: HyperBall needs a scope with at least two nodes and between "
+                << MIN_BITS << " and " << MAX_BITS << " bits per counter." << endl;
+        return result;
+    }
+
+    const Counters counters(bits);
+    const size_t size = counters.size();
+    clog << "Computing neighborhood function with HyperBall (" << size << " registers per node) with "
+            << omp_get_max_threads() << " CPUs..." << endl;
+
+    // counters of distance t - 1 and t, and the nodes whose counter changed
+    vector<uint8_t> current((size_t) n * size, 0), next((size_t) n * size);
+    vector<uint8_t> changed(n, 0), nowChanged(n, 0);
+    vector<double> estimates(n, 0), sums(n, 0);
+    result.harmonic.assign(n, 0);
+    result.closeness.assign(n, 0);
+#pragma omp parallel for schedule(static)
+    for(nodeindextype i = 0; i < n; i++)
+        if(inScope(i, scope)) {
+            counters.add(&current[(size_t) i * size], i);
+            estimates[i] = counters.estimate(&current[(size_t) i * size]);
+            changed[i] = 1;
+        }
+    result.pairs.push_back(nodes(scope));
+
+    for(int t = 1; ; t++) {
+        nodeindextype grownNodes = 0;
+        double grown = 0;
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+:grownNodes, grown)
+        for(nodeindextype i = 0; i < n; i++) {
+            nowChanged[i] = 0;
+            if(!inScope(i, scope))
+                continue;
+            uint8_t * c = &next[(size_t) i * size];
+            memcpy(c, &current[(size_t) i * size], size);
+            bool merged = false;
+            for(const nodeindextype j : E[i])
+                if(changed[j])
+                    merged = counters.merge(c, &current[(size_t) j * size]) || merged;
+            if(!merged)
+                continue;
+            const double estimate = counters.estimate(c), increase = estimate - estimates[i];
+            result.harmonic[i] += increase / t;
+            sums[i] += increase * t;
+            estimates[i] = estimate;
+            nowChanged[i] = 1;
+            grownNodes++;
+            grown += increase;
+        }
+        current.swap(next);
+        changed.swap(nowChanged);
+        if(grownNodes == 0)
+            break;
+        result.pairs.push_back(grown);
+        clog << " " << t;
+    }
+    clog << " Done." << endl;
+
+    for(nodeindextype i = 0; i < n; i++)
+        if(sums[i] > 0)
+            result.closeness[i] = nodes(scope) / sums[i];
+    return result;
+} // hyperBall
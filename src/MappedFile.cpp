@@ -0,0 +1,57 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Read-only memory mapping of a file
+ */
+
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace teexgraph;
+
+MappedFile::~MappedFile() {
+    close();
+} // destructor
+
+
+// map a regular, non-empty file, which is read front to back if sequential
+// is set and in any order otherwise; returns false if that is not possible
+bool MappedFile::open(const string & filename, const bool sequential) {
+    close();
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void * address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping stays valid after closing the descriptor
+    if(address == MAP_FAILED)
+        return false;
+
+    // edge lists are parsed front to back, so let the kernel read ahead
+    // aggressively and drop pages once they are read. other files, such as
+    // snapshots whose lists are used in place, keep the default behavior
+    madvise(address, info.st_size, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+    begin = static_cast<const char *>(address);
+    length = info.st_size;
+    return true;
+} // open
+
+
+// unmap the file, if any
+void MappedFile::close() {
+    if(begin != nullptr)
+        munmap(const_cast<char *>(begin), length);
+    begin = nullptr;
+    length = 0;
+} // close
@@ -0,0 +1,33 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Read-only memory mapping of a file, unmapped when the object goes out of scope
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace teexgraph {
+
+class MappedFile {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    bool open(const std::string & filename, const bool sequential = true);
+    void close();
+
+    const char * data() const { return begin; }
+    size_t size() const { return length; }
+    bool isOpen() const { return begin != nullptr; }
+
+  private:
+    const char * begin = nullptr;
+    size_t length = 0;
+};
+
+}
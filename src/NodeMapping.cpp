@@ -0,0 +1,254 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Mapping between input node identifiers and node ids 0, .., n-1
+ */
+
+#include <teexgraph/Graph.h>
+
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace teexgraph;
+
+namespace teexgraph {
+
+// a (buffer, begin, end) range of a set of edge buffers
+struct BufferSlice {
+    size_t buffer, begin, end;
+};
+
+// cut edge buffers into slices of roughly equal size for parallel processing
+template <typename Id>
+vector<BufferSlice> sliceBuffers(const vector< vector<Id> > & buffers) {
+    size_t total = 0;
+    for(size_t i = 0; i < buffers.size(); i++)
+        total += buffers[i].size();
+    const size_t target = max<size_t>(1 << 16, total / (4 * omp_get_max_threads()));
+    vector<BufferSlice> slices;
+    for(size_t i = 0; i < buffers.size(); i++)
+        for(size_t begin = 0; begin < buffers[i].size(); begin += target)
+            slices.push_back({i, begin, min(buffers[i].size(), begin + target)});
+    return slices;
+} // sliceBuffers
+
+
+template <typename Id>
+void NodeMapping<Id>::clear() {
+    ids.clear();
+    order.clear();
+    dense = true;
+} // clear
+
+
+// node id of an input identifier, or -1 if it does not occur in the graph
+template <typename Id>
+nodeindextype NodeMapping<Id>::find(const Id & id) const {
+    if(dense)
+        return findDense(id, is_integral<Id>());
+    if(order.empty()) {
+        const auto it = lower_bound(ids.begin(), ids.end(), id);
+        return (it != ids.end() && *it == id) ? (nodeindextype)(it - ids.begin()) : -1;
+    }
+    const auto it = lower_bound(order.begin(), order.end(), id,
+            [this](const nodeindextype i, const Id & value) { return ids[i] < value; });
+    return (it != order.end() && ids[*it] == id) ? *it : -1;
+} // find
+
+
+template <typename Id>
+nodeindextype NodeMapping<Id>::findDense(const Id & id, true_type) const {
+    return (id >= 0 && id < (Id) ids.size()) ? (nodeindextype) id : -1;
+} // findDense
+
+
+template <typename Id>
+nodeindextype NodeMapping<Id>::findDense(const Id &, false_type) const {
+    return -1; // never dense
+} // findDense
+
+
+// use a given table of identifiers, e.g. from a snapshot
+template <typename Id>
+void NodeMapping<Id>::assign(vector<Id> && table) {
+    ids = move(table);
+    index();
+} // assign
+
+
+// make this the mapping of base followed by the identifiers added, none of
+// which occurs in base, as node ids base.size(), base.size() + 1, ... the
+// table of base is copied once and its sorted order is merged with that of
+// added, in O(n + k log k) time for k added identifiers
+template <typename Id>
+void NodeMapping<Id>::extend(const NodeMapping & base, const vector<Id> & added) {
+    const nodeindextype oldn = base.size(), k = added.size();
+    ids.reserve(oldn + k);
+    ids.assign(base.ids.begin(), base.ids.end());
+    ids.insert(ids.end(), added.begin(), added.end());
+
+    vector<nodeindextype> addedOrder(k);
+    iota(addedOrder.begin(), addedOrder.end(), oldn);
+    sort(addedOrder.begin(), addedOrder.end(), [this](const nodeindextype a, const nodeindextype b) { return ids[a] < ids[b]; });
+    bool identity = is_integral<Id>::value && (base.dense || oldn == 0);
+    bool sorted = base.order.empty() && (k == 0 || oldn == 0 || ids[oldn - 1] < ids[oldn]);
+    for(nodeindextype j = 0; j < k; j++) {
+        identity = identity && ids[oldn + j] == (Id) (oldn + j);
+        sorted = sorted && addedOrder[j] == oldn + j;
+    }
+    dense = identity;
+    order.clear();
+    if(sorted)
+        return;
+
+    // merge the order of base, which is the identity if its table is sorted,
+    // with that of the added identifiers
+    const auto baseAt = [&](const nodeindextype i) { return base.order.empty() ? i : base.order[i]; };
+    order.resize(oldn + k);
+    for(nodeindextype i = 0, j = 0, at = 0; i < oldn || j < k; at++)
+        order[at] = (j == k || (i < oldn && ids[baseAt(i)] < ids[addedOrder[j]])) ? baseAt(i++) : addedOrder[j++];
+} // extend
+
+
+// determine how identifiers can be looked up in the table
+template <typename Id>
+void NodeMapping<Id>::index() {
+    const nodeindextype n = ids.size();
+    bool sorted = true, identity = is_integral<Id>::value;
+#pragma omp parallel for reduction(&&:sorted,identity)
+    for(nodeindextype i = 0; i < n; i++) {
+        sorted = sorted && (i == 0 || ids[i - 1] < ids[i]);
+        identity = identity && ids[i] == (Id) i;
+    }
+    dense = identity;
+    order.clear();
+    if(!sorted) {
+        order.resize(n);
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [this](const nodeindextype a, const nodeindextype b) { return ids[a] < ids[b]; });
+    }
+} // index
+
+
+// build the mapping from buffers of [u v u v ...] identifiers and replace the
+// identifiers by node ids; returns false if the identifiers cannot be mapped
+template <typename Id>
+bool NodeMapping<Id>::mapEdges(vector< vector<Id> > & buffers, const IdMapping mapping) {
+    clear();
+    if(mapping != IdMapping::SPARSE && mapDense(buffers, mapping, is_integral<Id>()))
+        return true;
+    if(mapping == IdMapping::DENSE) {
+        cerr << "Error: node identifiers are not in the range 0, .., "
+                << numeric_limits<nodeindextype>::max() - 1 << "." << endl;
+        return false;
+    }
+    mapSparse(buffers);
+    if(ids.size() >= (size_t) numeric_limits<nodeindextype>::max()) {
+        cerr << "Error: more than " << numeric_limits<nodeindextype>::max() - 1 << " distinct nodes." << endl;
+        clear();
+        return false;
+    }
+    return true;
+} // mapEdges
+
+
+// identifiers are node ids if they are 0, .., n-1 (DENSE: if they are in that range)
+template <typename Id>
+bool NodeMapping<Id>::mapDense(vector< vector<Id> > & buffers, const IdMapping mapping, true_type) {
+    const vector<BufferSlice> slices = sliceBuffers(buffers);
+    const int count = slices.size();
+    size_t total = 0;
+    Id minimum = 0, maximum = -1;
+    for(size_t i = 0; i < buffers.size(); i++)
+        total += buffers[i].size();
+    if(total > 0)
+        minimum = maximum = buffers[slices[0].buffer][0];
+
+#pragma omp parallel for reduction(min:minimum) reduction(max:maximum)
+    for(int i = 0; i < count; i++)
+        for(size_t j = slices[i].begin; j < slices[i].end; j++) {
+            minimum = min(minimum, buffers[slices[i].buffer][j]);
+            maximum = max(maximum, buffers[slices[i].buffer][j]);
+        }
+    if(minimum < 0 || (size_t) maximum >= (size_t) numeric_limits<nodeindextype>::max())
+        return false;
+
+    // without being told, check that every identifier up to the maximum occurs
+    if(mapping == IdMapping::AUTO) {
+        if((size_t) maximum >= total)
+            return false;
+        vector<char> present(maximum + 1, 0);
+#pragma omp parallel for
+        for(int i = 0; i < count; i++)
+            for(size_t j = slices[i].begin; j < slices[i].end; j++) {
+#pragma omp atomic write
+                present[buffers[slices[i].buffer][j]] = 1;
+            }
+        if(std::find(present.begin(), present.end(), 0) != present.end())
+            return false;
+    }
+
+    ids.resize(maximum + 1);
+    iota(ids.begin(), ids.end(), 0);
+    order.clear();
+    dense = true;
+    return true;
+} // mapDense
+
+
+template <typename Id>
+bool NodeMapping<Id>::mapDense(vector< vector<Id> > &, const IdMapping, false_type) {
+    return false;
+} // mapDense
+
+
+// number identifiers in sorted order: sort and deduplicate slices in parallel,
+// merge them pairwise and then look up each identifier in the merged table
+template <typename Id>
+void NodeMapping<Id>::mapSparse(vector< vector<Id> > & buffers) {
+    const vector<BufferSlice> slices = sliceBuffers(buffers);
+    const int count = slices.size();
+    vector< vector<Id> > distinct(count);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int i = 0; i < count; i++) {
+        distinct[i].assign(buffers[slices[i].buffer].begin() + slices[i].begin,
+                buffers[slices[i].buffer].begin() + slices[i].end);
+        sort(distinct[i].begin(), distinct[i].end());
+        distinct[i].erase(unique(distinct[i].begin(), distinct[i].end()), distinct[i].end());
+    }
+
+    for(int step = 1; step < count; step *= 2) {
+#pragma omp parallel for schedule(dynamic, 1)
+        for(int i = 0; i < count - step; i += 2 * step) {
+            vector<Id> merged;
+            merged.reserve(distinct[i].size() + distinct[i + step].size());
+            set_union(distinct[i].begin(), distinct[i].end(),
+                    distinct[i + step].begin(), distinct[i + step].end(), back_inserter(merged));
+            distinct[i].swap(merged);
+            vector<Id>().swap(distinct[i + step]);
+        }
+    }
+    if(count > 0)
+        ids.swap(distinct[0]);
+    order.clear();
+    dense = false;
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int i = 0; i < count; i++)
+        for(size_t j = slices[i].begin; j < slices[i].end; j++) {
+            Id & id = buffers[slices[i].buffer][j];
+            id = lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+        }
+} // mapSparse
+
+
+template class NodeMapping<nodeidtype>;
+
+}
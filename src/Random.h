@@ -0,0 +1,77 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Counter-based random numbers by Philox4x32-10, see the following paper:
+ *
+ * J.K. Salmon, M.A. Moraes, R.O. Dror and D.E. Shaw, Parallel Random Numbers:
+ * As Easy as 1, 2, 3, in Proceedings of the International Conference for High
+ * Performance Computing, Networking, Storage and Analysis (SC 2011), 2011.
+ * http://dx.doi.org/10.1145/2063384.2063405
+ *
+ * The n-th block of 128 random bits is a function of the seed and n only, so a
+ * generator holds no global state and its numbers are the same on every
+ * platform: a sample drawn with a given seed (see Graph::getSample()) can be
+ * reproduced exactly.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace teexgraph {
+
+class Random {
+  public:
+    explicit Random(const uint64_t seed) :
+            key{(uint32_t) seed, (uint32_t) (seed >> 32)}, counter{0, 0, 0, 0} {}
+
+    // next 64 random bits
+    uint64_t next() {
+        if(used == 2) {
+            generate();
+            used = 0;
+        }
+        used++;
+        return ((uint64_t) block[2 * used - 1] << 32) | block[2 * used - 2];
+    }
+
+    // uniform random number in [0, bound), for bound > 0, without modulo bias:
+    // numbers below 2^64 mod bound are rejected
+    uint64_t below(const uint64_t bound) {
+        const uint64_t threshold = -bound % bound;
+        uint64_t x;
+        do
+            x = next();
+        while(x < threshold);
+        return x % bound;
+    }
+
+  private:
+    uint32_t key[2];
+    uint32_t counter[4]; // block number in the first two words
+    uint32_t block[4];
+    int used = 2; // 64-bit halves of block handed out
+
+    // the next block: ten rounds of the Philox bijection over the counter
+    void generate() {
+        uint32_t x[4] = {counter[0], counter[1], counter[2], counter[3]};
+        uint32_t k[2] = {key[0], key[1]};
+        for(int round = 0; round < 10; round++) {
+            if(round > 0) {
+                k[0] += 0x9E3779B9;
+                k[1] += 0xBB67AE85;
+            }
+            const uint64_t p0 = (uint64_t) 0xD2511F53 * x[0], p1 = (uint64_t) 0xCD9E8D57 * x[2];
+            const uint32_t y[4] = {(uint32_t) (p1 >> 32) ^ x[1] ^ k[0], (uint32_t) p1,
+                    (uint32_t) (p0 >> 32) ^ x[3] ^ k[1], (uint32_t) p0};
+            for(int i = 0; i < 4; i++)
+                x[i] = y[i];
+        }
+        for(int i = 0; i < 4; i++)
+            block[i] = x[i];
+        if(++counter[0] == 0)
+            counter[1]++;
+    }
+};
+
+}
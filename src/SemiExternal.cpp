@@ -0,0 +1,150 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Semi-external mode, for graphs whose adjacency lists do not fit in memory.
+ * A snapshot loaded with loadSnapshot(filename, true) keeps all per-node state
+ * in memory, but the traversals below stream the out-lists from disk in
+ * sequential passes (see EdgeScanner.h) instead of following them at random:
+ * - WCCs by union-find, in a single pass over all lists;
+ * - BFS level by level, one pass per level that only reads the blocks holding
+ *   nodes of the current level, as used by the BoundingDiameters loop;
+ * - the distance distribution by 64 BFSs at a time, with one bit per source.
+ * Other functions read the lists through the memory-mapped snapshot.
+ */
+
+#include <teexgraph/Graph.h>
+
+#include "EdgeScanner.h"
+
+#include <bitset>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+using namespace teexgraph;
+
+
+// compute to which WCC each node belongs with union-find; components are
+// numbered by their lowest node id, exactly like computeWCC() does
+void Graph::computeWCCExternal() {
+    vector<nodeindextype> parent(n);
+    iota(parent.begin(), parent.end(), 0);
+    const auto find = [&](nodeindextype u) {
+        while(parent[u] != u) {
+            parent[u] = parent[parent[u]];
+            u = parent[u];
+        }
+        return u;
+    };
+
+    // the root of each set is its lowest node
+    scanner->scan(vector<bool>(scanner->blocks(), true),
+            [&](const nodeindextype u, const nodeindextype * begin, const nodeindextype * end) {
+        for(const nodeindextype * w = begin; w < end; w++) {
+            const nodeindextype a = find(u), b = find(*w);
+            if(a != b)
+                parent[max(a, b)] = min(a, b);
+        }
+    });
+
+    wccId.assign(n, 0);
+    wccNodes.assign(n + 1, 0);
+    wccEdges.assign(n + 1, 0);
+    largestWCC = wccs = 0;
+    for(nodeindextype i = 0; i < n; i++) {
+        const nodeindextype root = find(i);
+        wccId[i] = (root == i) ? ++wccs : wccId[root];
+        wccNodes[wccId[i]]++;
+        wccEdges[wccId[i]] += (long) E.degree(i) + (long) rE.degree(i);
+    }
+    for(nodeindextype c = 1; c <= wccs; c++)
+        if(wccNodes[c] > wccNodes[largestWCC])
+            largestWCC = c;
+
+    // because we count both reversed and normal edges we count edges double
+    if(!undirected)
+        for(nodeindextype c = 0; c <= wccs; c++)
+            wccEdges[c] /= 2;
+
+    doneWCC = true;
+    clog << "WCC computed." << endl << endl;
+} // computeWCCExternal
+
+
+// compute the eccentricity of node u like eccentricity(), level by level
+nodeindextype Graph::eccentricityExternal(const nodeindextype u) {
+    d.assign(n, -1);
+    vector<bool> active(scanner->blocks(), false), next;
+    nodeindextype level = 0;
+    bool found = true;
+
+    d[u] = 0;
+    active[scanner->blockOf(u)] = true;
+    while(found) {
+        found = false;
+        next.assign(scanner->blocks(), false);
+        scanner->scan(active, [&](const nodeindextype v, const nodeindextype * begin, const nodeindextype * end) {
+            if(d[v] != level)
+                return;
+            for(const nodeindextype * w = begin; w < end; w++)
+                if(d[*w] == -1 && pruned[*w] < 0) {
+                    d[*w] = level + 1;
+                    next[scanner->blockOf(*w)] = true;
+                    found = true;
+                }
+        });
+        if(found)
+            level++;
+        active.swap(next);
+    }
+    return level;
+} // eccentricityExternal
+
+
+// count the distances from the given sources like distances() does, running
+// one BFS per bit of a 64-bit word per node
+vector<long> Graph::distanceCountsExternal(const vector<nodeindextype> & sources) {
+    vector<long> counts(n, 0);
+    vector<uint64_t> visited, frontier, next;
+    vector<bool> active, nextActive;
+
+    for(size_t first = 0; first < sources.size(); first += 64) {
+        const size_t batch = min<size_t>(64, sources.size() - first);
+        if(sources.size() > 640 && (first / 64) % max<size_t>(1, sources.size() / 64 / 20) == 0) // show status %
+            clog << " " << first * 100 / sources.size() << "%";
+        visited.assign(n, 0);
+        frontier.assign(n, 0);
+        next.assign(n, 0);
+        active.assign(scanner->blocks(), false);
+        for(size_t k = 0; k < batch; k++) {
+            const nodeindextype s = sources[first + k];
+            visited[s] |= uint64_t(1) << k;
+            frontier[s] |= uint64_t(1) << k;
+            active[scanner->blockOf(s)] = true;
+        }
+        counts[0] += batch;
+
+        for(nodeindextype level = 1; find(active.begin(), active.end(), true) != active.end(); level++) {
+            nextActive.assign(scanner->blocks(), false);
+            scanner->scan(active, [&](const nodeindextype v, const nodeindextype * begin, const nodeindextype * end) {
+                const uint64_t bits = frontier[v];
+                if(bits == 0)
+                    return;
+                for(const nodeindextype * w = begin; w < end; w++) {
+                    const uint64_t reached = bits & ~visited[*w];
+                    if(reached != 0) {
+                        visited[*w] |= reached;
+                        next[*w] |= reached;
+                        counts[level] += bitset<64>(reached).count();
+                        nextActive[scanner->blockOf(*w)] = true;
+                    }
+                }
+            });
+            frontier.swap(next);
+            fill(next.begin(), next.end(), 0);
+            active.swap(nextActive);
+        }
+    }
+    return counts;
+} // distanceCountsExternal
@@ -0,0 +1,356 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Binary snapshots of a loaded graph. A snapshot holds the adjacency lists in
+ * offset/target form, the node identifiers, the graph status flags and,
+ * if computed, the WCC and SCC of each node, so that reloading it skips
+ * parsing, node mapping and sorting altogether.
+ *
+ * Layout (version 1, native byte order): a SnapshotHeader followed by these
+ * sections, each starting at a multiple of 8 bytes, where edge and node are the
+ * list position and node id types of the writer (see IndexTypes.h):
+ *   edge offsets[n+1], node targets[offsets[n]],
+ *   edge revOffsets[n+1], node revTargets[revOffsets[n]],
+ *   nodeidtype ids[n] or, with string identifiers, int64 nameOffsets[n+1], char names[nameOffsets[n]],
+ *   uint8 hasSelfLoop[n],
+ *   if WCC computed: node wccId[n], node wccNodes[wccs+1], int64 wccEdges[wccs+1],
+ *   if SCC computed: node sccId[n], node sccNodes[sccs+1], int64 sccEdges[sccs+1]
+ */
+
+#include <teexgraph/Graph.h>
+
+#include "EdgeScanner.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+using namespace teexgraph;
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'t', 'e', 'e', 'x', 's', 'n', 'a', 'p'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+enum SnapshotFlags : uint32_t {
+    SNAPSHOT_UNDIRECTED = 1,
+    SNAPSHOT_SORTEDANDUNIQUE = 2,
+    SNAPSHOT_WCC = 4,
+    SNAPSHOT_SCC = 8,
+    SNAPSHOT_STRING_IDS = 16
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t idBytes; // sizeof(nodeidtype) of the writer; 0 for string identifiers
+    uint16_t nodeBytes, edgeBytes; // sizeof(nodeindextype), sizeof(edgeindextype); 0 for 4 and 8
+    int64_t n, m, selfm;
+    int64_t wccs, largestWCC, sccs, largestSCC;
+};
+static_assert(sizeof(SnapshotHeader) == 80, "snapshot header must not contain padding");
+static_assert(sizeof(long) == sizeof(int64_t), "edge counts are stored as 64-bit integers");
+
+// round up to the next multiple of 8 bytes
+size_t aligned(const size_t bytes) {
+    return (bytes + 7) & ~(size_t) 7;
+} // aligned
+
+// write zero padding after a section of the given size
+bool writePadding(FILE * out, const size_t bytes) {
+    const char zeros[8] = {0};
+    return fwrite(zeros, 1, aligned(bytes) - bytes, out) == aligned(bytes) - bytes;
+} // writePadding
+
+// write an array followed by zero padding up to a multiple of 8 bytes. an
+// empty array, such as the reverse lists of an undirected graph, may have no
+// data at all
+bool writeSection(FILE * out, const void * data, const size_t bytes) {
+    if(bytes == 0)
+        return true;
+    return fwrite(data, 1, bytes, out) == bytes && writePadding(out, bytes);
+} // writeSection
+
+// sequential reader over the sections of a mapped snapshot
+class SectionReader {
+  public:
+    SectionReader(const MappedFile & file) : file(file), at(sizeof(SnapshotHeader)) {}
+
+    // pointer to the next section of count elements, or nullptr if the file is too short
+    template <typename T>
+    const T * next(const size_t count) {
+        const size_t bytes = count * sizeof(T);
+        if(at + bytes > file.size())
+            return nullptr;
+        const T * section = reinterpret_cast<const T *>(file.data() + at);
+        at += aligned(bytes);
+        return section;
+    }
+
+  private:
+    const MappedFile & file;
+    size_t at;
+};
+
+// node identifiers are stored by value, which only works for integer types
+template <typename Id>
+bool writeIds(FILE * out, const vector<Id> & ids, true_type) {
+    return writeSection(out, ids.data(), ids.size() * sizeof(Id));
+} // writeIds
+
+template <typename Id>
+bool writeIds(FILE *, const vector<Id> &, false_type) {
+    return false;
+} // writeIds
+
+template <typename Id>
+bool readIds(SectionReader & reader, vector<Id> & ids, const size_t count, true_type) {
+    const Id * section = reader.next<Id>(count);
+    if(section == nullptr)
+        return false;
+    ids.assign(section, section + count);
+    return true;
+} // readIds
+
+template <typename Id>
+bool readIds(SectionReader &, vector<Id> &, const size_t, false_type) {
+    return false;
+} // readIds
+
+} // namespace
+
+
+// save the graph in binary form to be reloaded with loadSnapshot()
+bool Graph::saveSnapshot(const string filename) const {
+    if(!loaded) {
+        cerr << "Error: no graph is loaded." << endl;
+        return false;
+    }
+    if(!is_integral<nodeidtype>::value) {
+        cerr << "Error: snapshots require an integer nodeidtype." << endl;
+        return false;
+    }
+
+    clog << "Saving snapshot to " << filename << " ..." << endl;
+    FILE * const out = fopen(filename.c_str(), "wb");
+    if(out == nullptr) {
+        cerr << "Error: cannot write to " << filename << "." << endl;
+        return false;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.flags = (undirected ? SNAPSHOT_UNDIRECTED : 0) |
+            (sortedandunique ? SNAPSHOT_SORTEDANDUNIQUE : 0) |
+            (doneWCC ? SNAPSHOT_WCC : 0) | (doneSCC ? SNAPSHOT_SCC : 0) |
+            (stringIds ? SNAPSHOT_STRING_IDS : 0);
+    header.idBytes = stringIds ? 0 : sizeof(nodeidtype);
+    header.nodeBytes = sizeof(nodeindextype);
+    header.edgeBytes = sizeof(edgeindextype);
+    header.n = n;
+    header.m = m;
+    header.selfm = selfm;
+    header.wccs = wccs;
+    header.largestWCC = largestWCC;
+    header.sccs = sccs;
+    header.largestSCC = largestSCC;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+
+    // adjacency lists, as stored in memory; compressed lists are stored plain
+    const Adjacency * lists[2] = {&E, &rE};
+    for(int k = 0; k < 2; k++) {
+        Adjacency plain;
+        if(lists[k]->isCompressed()) {
+            plain = *lists[k];
+            plain.decompress();
+        }
+        const Adjacency & list = lists[k]->isCompressed() ? plain : *lists[k];
+        ok = ok && writeSection(out, list.offsetArray(), (n + 1) * sizeof(edgeindextype)) &&
+                writeSection(out, list.targetArray(), list.edges() * sizeof(nodeindextype));
+    }
+
+    // node identifiers and self-loops
+    vector<uint8_t> selfLoops(n);
+    for(nodeindextype i = 0; i < n; i++)
+        selfLoops[i] = hasSelfLoop[i];
+    if(stringIds)
+        ok = ok && writeSection(out, names->offsetTable().data(), (n + 1) * sizeof(long)) &&
+                writeSection(out, names->arena().data(), names->arena().size());
+    else
+        ok = ok && writeIds(out, nodeMapping->table(), is_integral<nodeidtype>());
+    ok = ok && writeSection(out, selfLoops.data(), n);
+
+    // connected components, if computed
+    if(doneWCC)
+        ok = ok && writeSection(out, wccId.data(), n * sizeof(nodeindextype)) &&
+                writeSection(out, wccNodes.data(), (wccs + 1) * sizeof(nodeindextype)) &&
+                writeSection(out, wccEdges.data(), (wccs + 1) * sizeof(long));
+    if(doneSCC)
+        ok = ok && writeSection(out, sccId.data(), n * sizeof(nodeindextype)) &&
+                writeSection(out, sccNodes.data(), (sccs + 1) * sizeof(nodeindextype)) &&
+                writeSection(out, sccEdges.data(), (sccs + 1) * sizeof(long));
+
+    ok = (fclose(out) == 0) && ok;
+    if(!ok) {
+        cerr << "Error: writing snapshot " << filename << " failed." << endl;
+        return false;
+    }
+    clog << "Snapshot saved." << endl << endl;
+    return true;
+} // saveSnapshot
+
+
+// load a graph saved with saveSnapshot(); the file is mapped read-only and
+// the adjacency lists are read directly from the mapping. semi-external mode
+// streams the lists from the file instead where possible, see SemiExternal.cpp
+bool Graph::loadSnapshot(const string filename, const bool semiExternal) {
+    clog << endl << "Loading snapshot from " << filename << " ..." << endl;
+
+    // check if not already loaded
+    if(loaded) {
+        cerr << "Error: a graph is already loaded. Clear it first." << endl;
+        return false;
+    }
+
+    shared_ptr<MappedFile> mapping = make_shared<MappedFile>();
+    MappedFile & file = *mapping;
+    // not sequential: the lists are used in place and read in traversal order
+    if(!file.open(filename, false) || file.size() < sizeof(SnapshotHeader)) {
+        cerr << "Error: file " << filename << " not found or not a snapshot." << endl;
+        return false;
+    }
+    SnapshotHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        cerr << "Error: file " << filename << " is not a snapshot." << endl;
+        return false;
+    }
+    const bool withStrings = header.flags & SNAPSHOT_STRING_IDS;
+    if(header.version != SNAPSHOT_VERSION || (!withStrings && header.idBytes != sizeof(nodeidtype))) {
+        cerr << "Error: snapshot version " << header.version << " with " << header.idBytes
+                << "-byte node identifiers is not supported by this build." << endl;
+        return false;
+    }
+    const size_t nodeBytes = header.nodeBytes ? header.nodeBytes : 4;
+    const size_t edgeBytes = header.edgeBytes ? header.edgeBytes : 8;
+    if(nodeBytes != sizeof(nodeindextype) || edgeBytes != sizeof(edgeindextype)) {
+        cerr << "Error: snapshot with " << nodeBytes << "-byte node ids and " << edgeBytes
+                << "-byte list positions is not supported by this build." << endl;
+        return false;
+    }
+    if(header.n < 0 || header.n > numeric_limits<nodeindextype>::max()) {
+        cerr << "Error: snapshot " << filename << " is corrupt." << endl;
+        return false;
+    }
+
+    // locate all sections before touching the graph
+    const nodeindextype nodecount = header.n;
+    SectionReader reader(file);
+    const edgeindextype * offsets = reader.next<edgeindextype>(nodecount + 1);
+    const nodeindextype * targets = offsets ? reader.next<nodeindextype>(offsets[nodecount]) : nullptr;
+    const edgeindextype * revOffsets = targets ? reader.next<edgeindextype>(nodecount + 1) : nullptr;
+    const nodeindextype * revTargets = revOffsets ? reader.next<nodeindextype>(revOffsets[nodecount]) : nullptr;
+    vector<nodeidtype> ids;
+    const int64_t * nameOffsets = nullptr;
+    const char * nameChars = nullptr;
+    bool idsRead;
+    if(withStrings) {
+        nameOffsets = revTargets ? reader.next<int64_t>(nodecount + 1) : nullptr;
+        nameChars = (nameOffsets && nameOffsets[nodecount] >= 0) ? reader.next<char>(nameOffsets[nodecount]) : nullptr;
+        idsRead = nameChars != nullptr;
+    } else
+        idsRead = revTargets && readIds(reader, ids, nodecount, is_integral<nodeidtype>());
+    const uint8_t * selfLoops = idsRead ? reader.next<uint8_t>(nodecount) : nullptr;
+    const bool withWCC = header.flags & SNAPSHOT_WCC, withSCC = header.flags & SNAPSHOT_SCC;
+    const nodeindextype * wccSection[2] = {nullptr, nullptr}, * sccSection[2] = {nullptr, nullptr};
+    const int64_t * wccEdgeSection = nullptr, * sccEdgeSection = nullptr;
+    if(selfLoops && withWCC) {
+        wccSection[0] = reader.next<nodeindextype>(nodecount);
+        wccSection[1] = reader.next<nodeindextype>(header.wccs + 1);
+        wccEdgeSection = reader.next<int64_t>(header.wccs + 1);
+    }
+    if(selfLoops && withSCC) {
+        sccSection[0] = reader.next<nodeindextype>(nodecount);
+        sccSection[1] = reader.next<nodeindextype>(header.sccs + 1);
+        sccEdgeSection = reader.next<int64_t>(header.sccs + 1);
+    }
+    if(selfLoops == nullptr || (withWCC && wccEdgeSection == nullptr) ||
+            (withSCC && sccEdgeSection == nullptr)) {
+        cerr << "Error: snapshot " << filename << " is truncated." << endl;
+        return false;
+    }
+
+    clear();
+
+    // the mapping stays alive as long as the graph reads from it
+    E.view(nodecount, offsets, targets);
+    rE.view(nodecount, revOffsets, revTargets);
+    snapshot = mapping;
+    if(semiExternal) {
+        scanner = make_shared<EdgeScanner>(filename, reinterpret_cast<const char *>(targets) - file.data(),
+                offsets, nodecount);
+        if(!scanner->isOpen()) {
+            cerr << "Error: cannot read " << filename << " for semi-external mode." << endl;
+            clear();
+            return false;
+        }
+    }
+
+    if(withStrings) {
+        const shared_ptr<StringPool> pool = make_shared<StringPool>();
+        pool->assign(vector<char>(nameChars, nameChars + nameOffsets[nodecount]),
+                vector<long>(nameOffsets, nameOffsets + nodecount + 1));
+        names = pool;
+        stringIds = true;
+    } else {
+        const shared_ptr< NodeMapping<nodeidtype> > mapping = make_shared< NodeMapping<nodeidtype> >();
+        mapping->assign(move(ids));
+        nodeMapping = mapping;
+    }
+    hasSelfLoop.assign(nodecount, false);
+    for(nodeindextype i = 0; i < nodecount; i++)
+        hasSelfLoop[i] = selfLoops[i];
+
+    n = nodecount;
+    m = header.m;
+    selfm = header.selfm;
+    undirected = header.flags & SNAPSHOT_UNDIRECTED;
+    sortedandunique = header.flags & SNAPSHOT_SORTEDANDUNIQUE;
+
+    if(withWCC) {
+        wccs = header.wccs;
+        largestWCC = header.largestWCC;
+        wccId.assign(wccSection[0], wccSection[0] + n);
+        wccNodes.assign(n, 0);
+        wccEdges.assign(n, 0);
+        copy(wccSection[1], wccSection[1] + wccs + 1, wccNodes.begin());
+        copy(wccEdgeSection, wccEdgeSection + wccs + 1, wccEdges.begin());
+        doneWCC = true;
+    }
+    if(withSCC) {
+        sccs = header.sccs;
+        largestSCC = header.largestSCC;
+        sccId.assign(sccSection[0], sccSection[0] + n);
+        sccNodes.assign(n, 0);
+        sccEdges.assign(n, 0);
+        copy(sccSection[1], sccSection[1] + sccs + 1, sccNodes.begin());
+        copy(sccEdgeSection, sccEdgeSection + sccs + 1, sccEdges.begin());
+        doneSCC = true;
+    }
+
+    loaded = true;
+    clog << "- " << n << " nodes and " << m << " edges loaded" << endl;
+    if(semiExternal)
+        clog << "- Semi-external mode: out-lists are streamed from disk in " << scanner->blocks() << " blocks" << endl;
+    clog << "Loading done." << endl << endl;
+    return true;
+} // loadSnapshot
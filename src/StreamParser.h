@@ -0,0 +1,135 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Parallel parsing of an edge list in [u v] format that arrives as a stream of
+ * bytes, such as the output of a decompressor. One reader thread pulls large
+ * blocks from the source, cuts them at the last newline and hands them over
+ * through a bounded queue to the OpenMP threads, which parse the blocks with
+ * the same line parser as EdgeListParser.h. Each block yields its own
+ * [u v u v ...] buffer, so that the buffers together are in stream order.
+ */
+
+#pragma once
+
+#include "BlockSource.h"
+#include "BoundedQueue.h"
+#include "EdgeListParser.h"
+
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <thread>
+
+namespace teexgraph {
+
+// a newline-aligned piece [begin, end) of data, starting at offset in the stream
+struct StreamBlock {
+    long seq, offset;
+    std::vector<char> data;
+    size_t begin, end;
+};
+
+
+// parse the edge list coming from source in parallel into buffers. like reading
+// with >>, everything from the first line that cannot be parsed onwards is
+// ignored; stoppedAt tells at which byte of the stream that was, or is -1.
+// returns false if the source could not be read
+template <typename Integer>
+bool parseEdgeStream(BlockSource & source, std::vector< std::vector<Integer> > & buffers,
+        long & stoppedAt) {
+    const size_t blockSize = 1 << 22;
+    BoundedQueue<StreamBlock> queue(2 * omp_get_max_threads());
+    std::atomic<long> firstFailure(LONG_MAX); // lowest seq of a block with a bad line
+    std::vector<long> stops; // per block: stream offset of its bad line, or -1
+    std::mutex resultMutex;
+    bool readFailed = false;
+
+    buffers.clear();
+    std::thread reader([&]() {
+        std::vector<char> carry; // unprocessed bytes, starting at offset in the stream
+        long offset = 0, seq = 0;
+        bool header = true;
+        while(seq <= firstFailure) {
+            const size_t have = carry.size();
+            carry.resize(have + blockSize);
+            const long got = source.read(carry.data() + have, blockSize);
+            carry.resize(have + std::max(got, 0L));
+            if(got < 0) {
+                readFailed = true;
+                break;
+            }
+            const bool last = (got == 0);
+
+            // skip the header, which may span several blocks
+            size_t start = 0;
+            if(header) {
+                start = skipHeader(carry.data(), carry.size());
+                if(start == carry.size() && !last) {
+                    const char * newline = static_cast<const char *>(memrchr(carry.data(), '\n', carry.size()));
+                    if(newline != nullptr) { // keep only the unfinished line
+                        const size_t done = newline + 1 - carry.data();
+                        carry.erase(carry.begin(), carry.begin() + done);
+                        offset += done;
+                    }
+                    continue;
+                }
+                header = false;
+            }
+
+            // hand over all complete lines, keep the rest for the next block
+            size_t cut = carry.size();
+            if(!last) {
+                const char * newline = static_cast<const char *>(
+                        memrchr(carry.data() + start, '\n', carry.size() - start));
+                if(newline == nullptr) // a line longer than a block
+                    continue;
+                cut = newline + 1 - carry.data();
+            }
+            std::vector<char> rest(carry.begin() + cut, carry.end());
+            if(cut > start)
+                queue.push(StreamBlock{seq++, offset, std::move(carry), start, cut});
+            carry.swap(rest);
+            offset += cut;
+            if(last)
+                break;
+        }
+        queue.close();
+    });
+
+#pragma omp parallel
+    {
+        StreamBlock block;
+        while(queue.pop(block)) {
+            std::vector<Integer> out;
+            const char * begin = block.data.data() + block.begin;
+            const char * end = block.data.data() + block.end;
+            const char * stop = end;
+            if(block.seq < firstFailure) {
+                out.reserve((end - begin) / 8);
+                stop = parseEdgeLines(begin, end, out);
+            }
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if((long) buffers.size() <= block.seq) {
+                buffers.resize(block.seq + 1);
+                stops.resize(block.seq + 1, -1);
+            }
+            buffers[block.seq].swap(out);
+            if(stop != end) {
+                stops[block.seq] = block.offset + block.begin + (stop - begin);
+                if(block.seq < firstFailure)
+                    firstFailure = block.seq;
+            }
+        }
+    }
+    reader.join();
+
+    stoppedAt = -1;
+    if(firstFailure != LONG_MAX) {
+        stoppedAt = stops[firstFailure];
+        buffers.resize(firstFailure + 1);
+    }
+    return !readFailed;
+} // parseEdgeStream
+
+}
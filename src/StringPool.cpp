@@ -0,0 +1,234 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Interned string node identifiers
+ */
+
+#include <teexgraph/StringPool.h>
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+
+using namespace std;
+using namespace teexgraph;
+
+namespace {
+
+const int SHARD_BITS = 6; // the top bits of a hash choose one of 64 shards for interning
+
+int shardOf(const uint64_t hash) {
+    return hash >> (64 - SHARD_BITS);
+} // shardOf
+
+} // namespace
+
+
+void StringPool::clear() {
+    chars.clear();
+    offsets.assign(1, 0);
+    hashes.clear();
+    slots.assign(16, -1);
+} // clear
+
+
+// identifier of node i, with bounds checking
+string StringPool::at(const nodeindextype i) const {
+    if(i < 0 || i >= size())
+        throw out_of_range("node " + to_string(i) + " does not exist");
+    return (*this)[i];
+} // at
+
+
+// node id of a string, or -1 if it does not occur
+nodeindextype StringPool::find(const string & value) const {
+    return find(value.data(), value.size(), hashString(value.data(), value.size()));
+} // find
+
+
+nodeindextype StringPool::find(const char * data, const size_t length, const uint64_t hash) const {
+    const size_t mask = slots.size() - 1;
+    for(size_t k = hash & mask; slots[k] != -1; k = (k + 1) & mask) {
+        const nodeindextype i = slots[k];
+        if(hashes[i] == hash && (size_t)(offsets[i + 1] - offsets[i]) == length &&
+                memcmp(chars.data() + offsets[i], data, length) == 0)
+            return i;
+    }
+    return -1;
+} // find
+
+
+// node id of a string, which is added if it does not occur yet
+nodeindextype StringPool::intern(const char * data, const size_t length, const uint64_t hash) {
+    const size_t mask = slots.size() - 1;
+    size_t k = hash & mask;
+    for(; slots[k] != -1; k = (k + 1) & mask) {
+        const nodeindextype i = slots[k];
+        if(hashes[i] == hash && (size_t)(offsets[i + 1] - offsets[i]) == length &&
+                memcmp(chars.data() + offsets[i], data, length) == 0)
+            return i;
+    }
+    const nodeindextype i = size();
+    chars.insert(chars.end(), data, data + length);
+    offsets.push_back(chars.size());
+    hashes.push_back(hash);
+    slots[k] = i;
+    if(2 * hashes.size() > slots.size()) // keep the table at most half full
+        index();
+    return i;
+} // intern
+
+
+// replace tokens by node ids, interning all of them. the tokens are divided
+// over shards by hash, which are interned in parallel: a shard numbers its
+// strings in order of first occurrence, and the shards are numbered one
+// after another, so that the ids do not depend on the number of threads
+vector< vector<nodeindextype> > StringPool::internTokens(const vector< vector<StringToken> > & chunks) {
+    const int shards = 1 << SHARD_BITS;
+    const int count = chunks.size();
+    clear();
+
+    // positions of the tokens of each shard, per chunk
+    vector< vector< vector<size_t> > > positions(count, vector< vector<size_t> >(shards));
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int c = 0; c < count; c++)
+        for(size_t t = 0; t < chunks[c].size(); t++)
+            positions[c][shardOf(chunks[c][t].hash)].push_back(t);
+
+    // ids within each shard
+    vector< vector<nodeindextype> > ids(count);
+    for(int c = 0; c < count; c++)
+        ids[c].resize(chunks[c].size());
+    vector<StringPool> pools(shards);
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int s = 0; s < shards; s++)
+        for(int c = 0; c < count; c++) {
+            for(const size_t t : positions[c][s]) {
+                const StringToken & token = chunks[c][t];
+                ids[c][t] = pools[s].intern(token.data, token.length, token.hash);
+            }
+            vector<size_t>().swap(positions[c][s]);
+        }
+
+    // put the shards one after another
+    long total = 0;
+    for(int s = 0; s < shards; s++)
+        total += pools[s].size();
+    if(total > numeric_limits<nodeindextype>::max())
+        throw overflow_error("more than " + to_string(numeric_limits<nodeindextype>::max()) +
+                " distinct node identifiers; build with TEEXGRAPH_64BIT_NODES to load this graph");
+    vector<nodeindextype> base(shards, 0);
+    for(int s = 0; s < shards; s++) {
+        base[s] = size();
+        append(pools[s]);
+        pools[s] = StringPool();
+    }
+    index();
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int c = 0; c < count; c++)
+        for(size_t t = 0; t < chunks[c].size(); t++)
+            ids[c][t] += base[shardOf(chunks[c][t].hash)];
+    return ids;
+} // internTokens
+
+
+// renumber the strings: string i becomes string newId[i]
+void StringPool::permute(const vector<nodeindextype> & newId) {
+    const nodeindextype n = size();
+    vector<nodeindextype> oldId(n);
+    for(nodeindextype i = 0; i < n; i++)
+        oldId[newId[i]] = i;
+
+    vector<char> permutedChars(chars.size());
+    vector<long> permutedOffsets(n + 1, 0);
+    vector<uint64_t> permutedHashes(n);
+    for(nodeindextype i = 0; i < n; i++)
+        permutedOffsets[i + 1] = permutedOffsets[i] + (offsets[oldId[i] + 1] - offsets[oldId[i]]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < n; i++) {
+        copy(chars.begin() + offsets[oldId[i]], chars.begin() + offsets[oldId[i] + 1],
+                permutedChars.begin() + permutedOffsets[i]);
+        permutedHashes[i] = hashes[oldId[i]];
+    }
+
+    chars.swap(permutedChars);
+    offsets.swap(permutedOffsets);
+    hashes.swap(permutedHashes);
+    index();
+} // permute
+
+
+// make this the pool of the strings of base followed by the strings added,
+// none of which occurs in base. the arrays of base are copied once, and its
+// hash table is reused unless the added strings make it more than half full
+void StringPool::extend(const StringPool & base, const vector<string> & added) {
+    size_t length = base.chars.size();
+    for(const string & value : added)
+        length += value.size();
+    chars.reserve(length);
+    chars.assign(base.chars.begin(), base.chars.end());
+    offsets.reserve(base.offsets.size() + added.size());
+    offsets.assign(base.offsets.begin(), base.offsets.end());
+    hashes.reserve(base.hashes.size() + added.size());
+    hashes.assign(base.hashes.begin(), base.hashes.end());
+
+    const bool reindex = 2 * (base.hashes.size() + added.size()) > base.slots.size();
+    if(!reindex)
+        slots = base.slots;
+    const size_t mask = slots.size() - 1;
+    for(const string & value : added) {
+        const uint64_t hash = hashString(value.data(), value.size());
+        if(!reindex) {
+            size_t k = hash & mask;
+            while(slots[k] != -1)
+                k = (k + 1) & mask;
+            slots[k] = size();
+        }
+        chars.insert(chars.end(), value.begin(), value.end());
+        offsets.push_back(chars.size());
+        hashes.push_back(hash);
+    }
+    if(reindex)
+        index();
+} // extend
+
+
+// use a given arena with the offsets of its strings, e.g. from a snapshot
+void StringPool::assign(vector<char> && arena, vector<long> && stringOffsets) {
+    chars = move(arena);
+    offsets = move(stringOffsets);
+    const nodeindextype n = size();
+    hashes.resize(n);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(nodeindextype i = 0; i < n; i++)
+        hashes[i] = hashString(chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    index();
+} // assign
+
+
+// add the strings of other after the strings of this pool; the hash table
+// must be rebuilt with index() afterwards
+void StringPool::append(const StringPool & other) {
+    const long start = chars.size();
+    chars.insert(chars.end(), other.chars.begin(), other.chars.end());
+    for(nodeindextype i = 1; i <= other.size(); i++)
+        offsets.push_back(start + other.offsets[i]);
+    hashes.insert(hashes.end(), other.hashes.begin(), other.hashes.end());
+} // append
+
+
+// rebuild the hash table, at most half full
+void StringPool::index() {
+    size_t capacity = 16;
+    while(capacity < 2 * hashes.size() + 2)
+        capacity *= 2;
+    slots.assign(capacity, -1);
+    const size_t mask = capacity - 1;
+    for(size_t i = 0; i < hashes.size(); i++) {
+        size_t k = hashes[i] & mask;
+        while(slots[k] != -1)
+            k = (k + 1) & mask;
+        slots[k] = i;
+    }
+} // index
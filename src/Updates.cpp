@@ -0,0 +1,270 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Batched dynamic edge updates. The identifiers of a batch (see EdgeBatch) are
+ * mapped to node ids, turned into sorted per-node lists of inserted and deleted
+ * neighbors, and merged into the adjacency lists in parallel in a single pass.
+ * The WCCs are maintained incrementally for batches of insertions only, by
+ * merging the components joined by the inserted edges without traversing the
+ * graph. VersionedGraph (see VersionedGraph.h) publishes the updated graph as
+ * a new version, so that readers are not affected by a batch in progress.
+ */
+
+#include <teexgraph/Graph.h>
+#include <teexgraph/VersionedGraph.h>
+
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace teexgraph;
+
+
+// map the identifiers of a batch to node ids, in buffers of [u v u v ...]
+// pairs. deleted edges with an identifier that does not occur are dropped;
+// inserted identifiers that do not occur get new node ids n, n+1, .. in order
+// of first occurrence. next shares the mapping of this graph, or gets one that
+// extends it with the new identifiers (see NodeMapping::extend()). returns the
+// new number of nodes
+nodeindextype Graph::mapBatch(const EdgeBatch & batch, vector<nodeindextype> & added, vector<nodeindextype> & removed,
+        Graph & next) const {
+    removed.resize(stringIds ? batch.deletedNames.size() : batch.deleted.size());
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(size_t i = 0; i < removed.size(); i++)
+        removed[i] = stringIds ? names->find(batch.deletedNames[i]) : nodeMapping->find(batch.deleted[i]);
+    size_t kept = 0;
+    for(size_t i = 0; i < removed.size(); i += 2)
+        if(removed[i] >= 0 && removed[i + 1] >= 0) {
+            removed[kept++] = removed[i];
+            removed[kept++] = removed[i + 1];
+        }
+    removed.resize(kept);
+
+    added.resize(stringIds ? batch.insertedNames.size() : batch.inserted.size());
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(size_t i = 0; i < added.size(); i++)
+        added[i] = stringIds ? names->find(batch.insertedNames[i]) : nodeMapping->find(batch.inserted[i]);
+    next.nodeMapping = nodeMapping;
+    next.names = names;
+
+    if(stringIds) {
+        unordered_map<string, nodeindextype> newIds;
+        vector<string> newNames;
+        for(size_t i = 0; i < added.size(); i++)
+            if(added[i] < 0) {
+                const auto entry = newIds.emplace(batch.insertedNames[i], n + (nodeindextype) newIds.size());
+                if(entry.second)
+                    newNames.push_back(batch.insertedNames[i]);
+                added[i] = entry.first->second;
+            }
+        if(!newNames.empty()) {
+            const shared_ptr<StringPool> pool = make_shared<StringPool>();
+            pool->extend(*names, newNames);
+            next.names = pool;
+        }
+        return n + newNames.size();
+    }
+
+    unordered_map<nodeidtype, nodeindextype> newIds;
+    vector<nodeidtype> newIdentifiers;
+    for(size_t i = 0; i < added.size(); i++)
+        if(added[i] < 0) {
+            const auto entry = newIds.emplace(batch.inserted[i], n + (nodeindextype) newIds.size());
+            if(entry.second)
+                newIdentifiers.push_back(batch.inserted[i]);
+            added[i] = entry.first->second;
+        }
+    if(!newIdentifiers.empty()) {
+        const shared_ptr< NodeMapping<nodeidtype> > mapping = make_shared< NodeMapping<nodeidtype> >();
+        mapping->extend(*nodeMapping, newIdentifiers);
+        next.nodeMapping = mapping;
+    }
+    return n + newIdentifiers.size();
+} // mapBatch
+
+
+// apply a batch of edge insertions and deletions. for undirected graphs, each
+// edge is inserted or deleted in both directions
+bool Graph::applyBatch(const EdgeBatch & batch) {
+    if(loaded)
+        sortEdgeList();
+    Graph next;
+    if(!applyBatch(batch, next))
+        return false;
+    *this = move(next);
+    return true;
+} // applyBatch
+
+
+// apply a batch of edge insertions and deletions to this graph, leaving it
+// unchanged: next becomes the updated graph. its lists are merged from the
+// lists of this graph without copying them first, and it shares the node
+// mapping with this graph unless the batch adds nodes. the lists of this graph
+// must be sorted (see sortEdgeList())
+bool Graph::applyBatch(const EdgeBatch & batch, Graph & next) const {
+    if(!loaded) {
+        cerr << "Error: no graph is loaded to apply the batch to." << endl;
+        return false;
+    }
+    if(!sortedandunique) {
+        cerr << "Error: the edge lists must be sorted before applying a batch." << endl;
+        return false;
+    }
+    const bool numbers = !batch.inserted.empty() || !batch.deleted.empty();
+    const bool strings = !batch.insertedNames.empty() || !batch.deletedNames.empty();
+    if((stringIds && numbers) || (!stringIds && strings)) {
+        cerr << "Error: the batch uses " << (stringIds ? "integer" : "string")
+                << " node identifiers, but the graph does not." << endl;
+        return false;
+    }
+
+    clog << "Applying a batch of " << batch.size() << " edge updates..." << endl;
+    next.clear();
+    vector< vector<nodeindextype> > added(1), removed(1);
+    const nodeindextype nodecount = mapBatch(batch, added[0], removed[0], next);
+    if(undirected)
+        for(vector<nodeindextype> * buffer : {&added[0], &removed[0]}) {
+            const size_t size = buffer->size();
+            for(size_t i = 0; i < size; i += 2) {
+                buffer->push_back((*buffer)[i + 1]);
+                buffer->push_back((*buffer)[i]);
+            }
+        }
+
+    // merge the sorted lists of added and removed neighbors into the lists
+    Adjacency addedLists, removedLists;
+    addedLists.build(nodecount, added, false);
+    addedLists.sortUnique();
+    removedLists.build(nodecount, removed, false);
+    removedLists.sortUnique();
+    next.E.update(E, nodecount, addedLists, removedLists);
+    if(undirected)
+        next.rE.empty(nodecount);
+    else {
+        addedLists.build(nodecount, added, true);
+        addedLists.sortUnique();
+        removedLists.build(nodecount, removed, true);
+        removedLists.sortUnique();
+        next.rE.update(rE, nodecount, addedLists, removedLists);
+    }
+    next.stringIds = stringIds;
+    next.n = nodecount;
+    next.m = next.E.edges();
+    next.loaded = next.sortedandunique = true;
+    next.undirected = undirected;
+
+    next.hasSelfLoop = hasSelfLoop;
+    next.hasSelfLoop.resize(nodecount, false);
+    next.selfm = selfm;
+    for(size_t i = 0; i < removed[0].size(); i += 2) {
+        const nodeindextype u = removed[0][i];
+        if(u == removed[0][i + 1] && next.hasSelfLoop[u] && !next.edge(u, u)) {
+            next.hasSelfLoop[u] = false;
+            next.selfm--;
+        }
+    }
+    for(size_t i = 0; i < added[0].size(); i += 2) {
+        const nodeindextype u = added[0][i];
+        if(u == added[0][i + 1] && !next.hasSelfLoop[u]) {
+            next.hasSelfLoop[u] = true;
+            next.selfm++;
+        }
+    }
+
+    // deletions may split components; insertions can only merge them. the
+    // SCCs, a distance index and a snapshot to read from are not carried over
+    if(doneWCC && removed[0].empty())
+        next.updateWCC(*this, added[0]);
+    clog << "- " << nodecount - n << " nodes added, m = " << next.m << endl;
+    clog << "Batch applied." << endl << endl;
+    return true;
+} // applyBatch
+
+
+// compute the WCCs from those of base after inserting the [u v u v ...] edges
+// of added, in O(n) time without a traversal: the nodes that base does not
+// have start as components of their own, and the components are merged along
+// the inserted edges. components stay numbered in order of their lowest node,
+// like computeWCC()
+void Graph::updateWCC(const Graph & base, const vector<nodeindextype> & added) {
+    const nodeindextype oldn = base.n;
+    const auto component = [&](const nodeindextype i) {
+        return (i < oldn) ? base.wccId[i] : base.wccs + 1 + (i - oldn);
+    };
+    wccs = base.wccs + (n - oldn);
+
+    // the root of each set is its lowest component
+    vector<nodeindextype> parent(wccs + 1);
+    iota(parent.begin(), parent.end(), 0);
+    const auto find = [&](nodeindextype c) {
+        while(parent[c] != c) {
+            parent[c] = parent[parent[c]];
+            c = parent[c];
+        }
+        return c;
+    };
+    for(size_t i = 0; i < added.size(); i += 2) {
+        const nodeindextype a = find(component(added[i])), b = find(component(added[i + 1]));
+        if(a != b)
+            parent[max(a, b)] = min(a, b);
+    }
+
+    vector<nodeindextype> number(wccs + 1, 0);
+    nodeindextype count = 0;
+    for(nodeindextype c = 1; c <= wccs; c++)
+        number[c] = (find(c) == c) ? ++count : number[find(c)];
+    wccId.resize(n);
+#pragma omp parallel for schedule(static)
+    for(nodeindextype i = 0; i < n; i++)
+        wccId[i] = number[component(i)];
+
+    wccNodes.assign(n + 1, 0);
+    wccEdges.assign(n + 1, 0);
+    largestWCC = 0;
+    wccs = count;
+    for(nodeindextype i = 0; i < n; i++) {
+        wccNodes[wccId[i]]++;
+        wccEdges[wccId[i]] += (long) E.degree(i) + (long) rE.degree(i);
+    }
+    for(nodeindextype c = 1; c <= wccs; c++)
+        if(wccNodes[c] > wccNodes[largestWCC])
+            largestWCC = c;
+
+    // because we count both reversed and normal edges we count edges double
+    if(!undirected)
+        for(nodeindextype c = 0; c <= wccs; c++)
+            wccEdges[c] /= 2;
+    doneWCC = true;
+    clog << "- WCCs updated (" << wccs << " components)" << endl;
+} // updateWCC
+
+
+// the first version; its lists are sorted here, because batches are applied
+// to versions that can no longer be changed
+VersionedGraph::VersionedGraph(Graph && graph) {
+    if(graph.isLoaded())
+        graph.sortEdgeList();
+    version = make_shared<const Graph>(move(graph));
+} // VersionedGraph constructor
+
+
+// the current version, which readers can keep using for as long as they
+// hold it, regardless of batches applied in the meantime
+shared_ptr<const Graph> VersionedGraph::current() const {
+    return atomic_load(&version);
+} // current
+
+
+// build the next version from the current one and the batch, and publish it.
+// the current version is only read, and shares its node mapping with the next
+// one if the batch adds no nodes. batches are applied one at a time
+bool VersionedGraph::apply(const EdgeBatch & batch) {
+    lock_guard<mutex> lock(writer);
+    shared_ptr<Graph> next = make_shared<Graph>();
+    if(!current()->applyBatch(batch, *next))
+        return false;
+    atomic_store(&version, shared_ptr<const Graph>(move(next)));
+    return true;
+} // apply
@@ -0,0 +1,92 @@
+/*
+ * teexGraph --- by Frank Takes --- https://github.com/franktakes/teexgraph
+ *
+ * Scratch space for traversals, one per thread, which is kept between calls so
+ * that a traversal does not allocate and clear arrays of n elements every time.
+ * Distances are epoch-stamped: a node only counts as visited if its stamp
+ * equals the epoch of the current traversal, so starting a new traversal is
+ * O(1) instead of O(n), which matters for the many traversals of a sampled
+ * computation that only reach part of the graph. A traversal must not start
+ * another traversal on the same thread while it uses the workspace.
+ */
+
+#pragma once
+
+#include <teexgraph/IndexTypes.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace teexgraph {
+
+class Workspace {
+  public:
+    // the workspace of the calling thread
+    static Workspace & local() {
+        static thread_local Workspace workspace;
+        return workspace;
+    }
+
+    // start a traversal of a graph with n nodes, in which no node is visited
+    void start(const nodeindextype n) {
+        if((nodeindextype) stamps.size() != n) {
+            stamps.assign(n, 0);
+            dist.resize(n);
+        }
+        if(++epoch == 0) { // the stamps wrapped around
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+        order.clear();
+    }
+
+    // copy the distances of the current traversal into d, with -1 for the
+    // nodes that are not visited
+    void distances(std::vector<nodeindextype> & d) const {
+        d.assign(stamps.size(), -1);
+        for(const nodeindextype w : order)
+            d[w] = dist[w];
+    }
+
+    // atomic, since other threads may claim() w at the same time
+    bool visited(const nodeindextype w) const {
+        return __atomic_load_n(&stamps[w], __ATOMIC_RELAXED) == epoch;
+    }
+
+    // distance of node w in the current traversal, or -1 if it is not visited
+    nodeindextype distance(const nodeindextype w) const {
+        return visited(w) ? dist[w] : -1;
+    }
+
+    void visit(const nodeindextype w, const nodeindextype distance) {
+        stamps[w] = epoch;
+        dist[w] = distance;
+    }
+
+    // visit w unless it is visited already, also when other threads try to
+    // visit it at the same time; returns whether this call visited w
+    bool claim(const nodeindextype w, const nodeindextype distance) {
+        uint32_t stamp = __atomic_load_n(&stamps[w], __ATOMIC_RELAXED);
+        if(stamp == epoch || !__atomic_compare_exchange_n(&stamps[w], &stamp, epoch, false,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return false;
+        dist[w] = distance;
+        return true;
+    }
+
+    std::vector<nodeindextype> order; // visited nodes in order of distance
+    std::vector<nodeindextype> next; // nodes found for the next level
+    std::vector<nodeindextype> list; // any list of nodes, e.g. a neighborhood
+    std::vector<nodeindextype> parents; // node a visited node was reached from
+    std::vector<uint64_t> bitmap; // a bit per node, for the level of a bottom-up step
+    std::vector<uint64_t> seen, current, reached; // a word per node, for multi-source BFS
+    std::vector<double> paths, dependencies; // a value per node, for betweenness
+
+  private:
+    std::vector<uint32_t> stamps; // node w is visited if stamps[w] == epoch
+    std::vector<nodeindextype> dist;
+    uint32_t epoch = 0;
+};
+
+}
@@ -99,20 +99,20 @@ void clusteringStats(Graph & G, double samplingRate = 1.0) {
 void boundingDiameters(Graph & G) {
     const int LEFTWIDTH = 40;
 	
-	int diameter = G.diameterBD();
+	nodeindextype diameter = G.diameterBD();
     cout << setw(LEFTWIDTH) << "WCC diameter: " << diameter << endl;
 
-	//int radius = G.radiusBD();
+	//nodeindextype radius = G.radiusBD();
     //cout << setw(LEFTWIDTH) << "WCC radius: " << radius << endl;
 
-	//int periphery = G.peripherySizeBD();
+	//nodeindextype periphery = G.peripherySizeBD();
     //cout << setw(LEFTWIDTH) << "WCC periphery size: " << periphery << endl;
 	
-	//int center = G.centerSizeBD();
+	//nodeindextype center = G.centerSizeBD();
     //cout << setw(LEFTWIDTH) << "WCC center size: " << center << endl;
 
 	// eccentricity distribution
-    //vector<int> eccs = G.eccentricitiesBD();
+    //vector<nodeindextype> eccs = G.eccentricitiesBD();
 	//G.printDistri(eccs, Scope::LWCC);
 }
 
@@ -1,20 +1,75 @@
 #include <teexgraph/Graph.h>
 
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
 #include <cstdint>
 #include <memory>
+#include <stdexcept>
 
 using namespace teexgraph;
 
 namespace py = pybind11;
 
-std::unique_ptr<Graph> make_graph_from_vectors(
-    const std::vector<int64_t>& sources,
-    const std::vector<int64_t>& targets
+// arrays of node identifiers are passed to the loader as pointers, without
+// conversion to a vector; the loader copies them once (see loadDirectedFromArrays)
+template <typename Integer>
+using id_array = py::array_t<Integer, py::array::c_style>;
+
+// any other numeric array, e.g. of floats or unsigned integers, which NumPy
+// first casts to a temporary int64 array; its overloads are registered last,
+// so that int32 and int64 arrays are never cast
+using cast_id_array = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+
+template <typename Array>
+void load_from_arrays(
+    Graph &graph,
+    const Array& sources,
+    const Array& targets,
+    const IdMapping mapping
+){
+    using Integer = typename Array::value_type;
+    if(sources.ndim() != 1 || targets.ndim() != 1 || sources.size() != targets.size()){
+        throw std::invalid_argument("Sources and Targets must be one-dimensional and of the same length!");
+    }
+    const Integer* source_data = sources.data();
+    const Integer* target_data = targets.data();
+    const size_t count = sources.size();
+    py::gil_scoped_release release;
+    graph.loadDirectedFromArrays(source_data, target_data, count, mapping);
+}
+
+template <typename Array>
+std::unique_ptr<Graph> make_graph_from_arrays(
+    const Array& sources,
+    const Array& targets
 ){
-    return std::make_unique<Graph>(sources, targets);
+    std::unique_ptr<Graph> graph(new Graph());
+    load_from_arrays(*graph, sources, targets, IdMapping::AUTO);
+    return graph;
+}
+
+// hand a result vector to NumPy, which then owns it; the elements are not copied
+template <typename T>
+py::array_t<T> to_array(std::vector<T>&& values){
+    std::vector<T>* owned = new std::vector<T>(std::move(values));
+    py::capsule free_when_done(owned, [](void *p){
+        delete static_cast<std::vector<T>*>(p);
+    });
+    return py::array_t<T>(owned->size(), owned->data(), free_when_done);
+}
+
+// read-only NumPy view on an adjacency list; it keeps the Python graph object
+// alive, but is invalidated when that graph is cleared or changed. compressed
+// lists are decoded into a new array instead
+py::array_t<nodeindextype> list_view(const NodeSpan& list, const py::object& owner){
+    if(list.isCompressed()){
+        return to_array(std::vector<nodeindextype>(list.begin(), list.end()));
+    }
+    py::array_t<nodeindextype> view(list.size(), list.data(), owner);
+    view.attr("setflags")(py::arg("write") = false);
+    return view;
 }
 
 
@@ -28,25 +83,71 @@ PYBIND11_MODULE(pyteexgraph, m) {
       .value("LSCC", Scope::LSCC)
       .export_values();
 
+  py::enum_<IdMapping>(m, "IdMapping")
+      .value("AUTO", IdMapping::AUTO)
+      .value("DENSE", IdMapping::DENSE)
+      .value("SPARSE", IdMapping::SPARSE)
+      .value("STRING", IdMapping::STRING)
+      .export_values();
+
+  py::enum_<Ordering>(m, "Ordering")
+      .value("DEGREE", Ordering::DEGREE)
+      .value("RCM", Ordering::RCM)
+      .value("GORDER", Ordering::GORDER)
+      .export_values();
+
+  py::class_<EdgeBatch>(m, "EdgeBatch")
+    .def(py::init<>())
+    .def("insertEdge", static_cast<void (EdgeBatch::*)(const nodeidtype, const nodeidtype)>(&EdgeBatch::insertEdge),
+        py::arg("u"), py::arg("v"))
+    .def("insertEdge", static_cast<void (EdgeBatch::*)(const std::string &, const std::string &)>(&EdgeBatch::insertEdge),
+        py::arg("u"), py::arg("v"))
+    .def("deleteEdge", static_cast<void (EdgeBatch::*)(const nodeidtype, const nodeidtype)>(&EdgeBatch::deleteEdge),
+        py::arg("u"), py::arg("v"))
+    .def("deleteEdge", static_cast<void (EdgeBatch::*)(const std::string &, const std::string &)>(&EdgeBatch::deleteEdge),
+        py::arg("u"), py::arg("v"))
+    .def("size", &EdgeBatch::size)
+    .def("empty", &EdgeBatch::empty)
+    .def("clear", &EdgeBatch::clear);
+
+  py::class_<NeighborhoodFunction>(m, "NeighborhoodFunction")
+    .def_property_readonly("pairs", [](const NeighborhoodFunction &self){
+        return to_array(std::vector<double>(self.pairs));
+    })
+    .def_property_readonly("harmonic", [](const NeighborhoodFunction &self){
+        return to_array(std::vector<double>(self.harmonic));
+    })
+    .def_property_readonly("closeness", [](const NeighborhoodFunction &self){
+        return to_array(std::vector<double>(self.closeness));
+    })
+    .def("averageDistance", &NeighborhoodFunction::averageDistance)
+    .def("effectiveDiameter", &NeighborhoodFunction::effectiveDiameter, py::arg("fraction") = 0.9);
+
   py::class_<Graph>(m, "Graph")
     .def("__deepcopy__", [](const Graph &self, py::dict) {
         return Graph(self);
     }, "memo")
 
     .def(py::init<>())
-    .def(py::init<const int>())
+    .def(py::init<const nodeindextype>())
     .def(py::init<const std::string&, const bool>(), py::arg("filename"), py::arg("directed"))
-    .def(py::init(&make_graph_from_vectors), py::arg("sources"), py::arg("targets"))
-
-    .def("loadDirected", &Graph::loadDirected, py::arg("filename"))
-    .def("loadUndirected", &Graph::loadUndirected, py::arg("filename"))
-    .def("loadDirectedFromVectors",
-        [](
-            Graph &self,
-            const std::vector<int64_t>& sources,
-            const std::vector<int64_t>& targets
-        ){ self.loadDirectedFromVectors(sources, targets); },
-        py::arg("sources"), py::arg("targets")
+    .def(py::init(&make_graph_from_arrays< id_array<int64_t> >), py::arg("sources"), py::arg("targets"))
+    .def(py::init(&make_graph_from_arrays< id_array<int32_t> >), py::arg("sources"), py::arg("targets"))
+    .def(py::init(&make_graph_from_arrays<cast_id_array>), py::arg("sources"), py::arg("targets"))
+
+    .def("loadDirected", &Graph::loadDirected, py::arg("filename"), py::arg("mapping") = IdMapping::AUTO)
+    .def("loadUndirected", &Graph::loadUndirected, py::arg("filename"), py::arg("mapping") = IdMapping::AUTO)
+    .def("loadDirectedFromFd", &Graph::loadDirectedFromFd, py::arg("fd"), py::arg("mapping") = IdMapping::AUTO)
+    .def("loadSnapshot", &Graph::loadSnapshot, py::arg("filename"), py::arg("semi_external") = false)
+    .def("saveSnapshot", &Graph::saveSnapshot, py::arg("filename"))
+    .def("loadDirectedFromVectors", &load_from_arrays< id_array<int64_t> >,
+        py::arg("sources"), py::arg("targets"), py::arg("mapping") = IdMapping::AUTO
+    )
+    .def("loadDirectedFromVectors", &load_from_arrays< id_array<int32_t> >,
+        py::arg("sources"), py::arg("targets"), py::arg("mapping") = IdMapping::AUTO
+    )
+    .def("loadDirectedFromVectors", &load_from_arrays<cast_id_array>,
+        py::arg("sources"), py::arg("targets"), py::arg("mapping") = IdMapping::AUTO
     )
 
     .def("clear", &Graph::clear)
@@ -55,12 +156,19 @@ PYBIND11_MODULE(pyteexgraph, m) {
     .def("isLoaded", &Graph::isLoaded)
     .def("isUndirected", &Graph::isUndirected)
     .def("isSortedAndUnique", &Graph::isSortedAndUnique)
+    .def("isCompressed", &Graph::isCompressed)
+    .def("hasStringIds", &Graph::hasStringIds)
+    .def("isSemiExternal", &Graph::isSemiExternal)
+    .def("hasDistanceIndex", &Graph::hasDistanceIndex)
     .def("sccComputed", &Graph::sccComputed)
     .def("wccComputed", &Graph::wccComputed)
     .def("inScope", &Graph::inScope, py::arg("node_id"), py::arg("scope"))
 
     // manipulation
     .def("makeUndirected", &Graph::makeUndirected)
+    .def("compress", &Graph::compress)
+    .def("reorder", &Graph::reorder, py::arg("ordering"))
+    .def("applyBatch", static_cast<bool (Graph::*)(const EdgeBatch &)>(&Graph::applyBatch), py::arg("batch"))
 
     // components
     .def("computeSCC", &Graph::computeSCC)
@@ -78,8 +186,18 @@ PYBIND11_MODULE(pyteexgraph, m) {
     .def("selfEdges", &Graph::selfEdges, py::arg("scope"))
     .def("wccCount", &Graph::wccCount)
     .def("wccOf", &Graph::wccOf, py::arg("wcc_id"))
-    .def("revNeighbors", &Graph::revNeighbors, py::arg("node_id"))
-    .def("neighbors", &Graph::neighbors, py::arg("node_id"))
+    .def("mapNode", static_cast<nodeindextype (Graph::*)(const nodeidtype) const>(&Graph::mapNode),
+        py::arg("identifier"))
+    .def("mapNode", static_cast<nodeindextype (Graph::*)(const std::string &) const>(&Graph::mapNode),
+        py::arg("identifier"))
+    .def("revMapNode", &Graph::revMapNode, py::arg("node_id"))
+    .def("nodeName", &Graph::nodeName, py::arg("node_id"))
+    .def("revNeighbors", [](const py::object &self, const nodeindextype node_id){
+        return list_view(self.cast<const Graph &>().revNeighbors(node_id), self);
+    }, py::arg("node_id"))
+    .def("neighbors", [](const py::object &self, const nodeindextype node_id){
+        return list_view(self.cast<const Graph &>().neighbors(node_id), self);
+    }, py::arg("node_id"))
 
     // BoundingDiameters functions
     .def("centerSizeBD", &Graph::centerSizeBD)
@@ -88,11 +206,12 @@ PYBIND11_MODULE(pyteexgraph, m) {
     .def("peripherySizeBD", &Graph::peripherySizeBD)
     .def("radiusAPSP", &Graph::radiusAPSP)
     .def("radiusBD", &Graph::radiusBD)
-    .def("eccentricitiesAPSP", &Graph::eccentricitiesAPSP)
-    .def("eccentricitiesBD", &Graph::eccentricitiesBD)
+    .def("eccentricitiesAPSP", [](Graph &self){ return to_array(self.eccentricitiesAPSP()); })
+    .def("eccentricitiesBD", [](Graph &self){ return to_array(self.eccentricitiesBD()); })
 
     // triangles and clustering
-    .def("averageClusteringCoefficient", &Graph::averageClusteringCoefficient, py::arg("scope"), py::arg("sample_fraction")) 
+    .def("averageClusteringCoefficient", &Graph::averageClusteringCoefficient, py::arg("scope"), py::arg("sample_fraction"),
+        py::arg("seed") = 0)
     .def("graphClusteringCoefficient", &Graph::graphClusteringCoefficient, py::arg("scope"))
     .def("triangles", &Graph::triangles, py::arg("scope"))
     .def("wedges", &Graph::wedges, py::arg("scope"))
@@ -101,26 +220,50 @@ PYBIND11_MODULE(pyteexgraph, m) {
     // pair<long, long> trianglesWedgesAround(const int);
 
 	// centrality
-    .def("betweennessCentrality", &Graph::betweennessCentrality, py::arg("scope"), py::arg("sample_fraction"))
-    .def("closenessCentrality", &Graph::closenessCentrality, py::arg("scope"), py::arg("sample_fraction"))
-    .def("degreeCentrality", &Graph::degreeCentrality)
-    .def("eccentricityCentrality", &Graph::eccentricityCentrality, py::arg("scope"))
-    .def("indegreeCentrality", &Graph::indegreeCentrality)
-    .def("outdegreeCentrality", &Graph::outdegreeCentrality)
-    .def("pageRankCentrality", &Graph::pageRankCentrality)
+    .def("betweennessCentrality", [](Graph &self, const Scope scope, const double sample_fraction, const uint64_t seed){
+        return to_array(self.betweennessCentrality(scope, sample_fraction, seed));
+    }, py::arg("scope"), py::arg("sample_fraction"), py::arg("seed") = 0)
+    .def("closenessCentrality", [](Graph &self, const Scope scope, const double sample_fraction, const uint64_t seed){
+        return to_array(self.closenessCentrality(scope, sample_fraction, seed));
+    }, py::arg("scope"), py::arg("sample_fraction"), py::arg("seed") = 0)
+    .def("degreeCentrality", [](Graph &self){ return to_array(self.degreeCentrality()); })
+    .def("eccentricityCentrality", [](Graph &self, const Scope scope){
+        return to_array(self.eccentricityCentrality(scope));
+    }, py::arg("scope"))
+    .def("indegreeCentrality", [](Graph &self){ return to_array(self.indegreeCentrality()); })
+    .def("outdegreeCentrality", [](Graph &self){ return to_array(self.outdegreeCentrality()); })
+    .def("pageRankCentrality", [](Graph &self){ return to_array(self.pageRankCentrality()); })
 
     // distances, degree and compont size distributions
-    .def("distanceDistribution", &Graph::distanceDistribution, py::arg("scope"), py::arg("sample_fraction"))
-    .def("indegreeDistribution", &Graph::indegreeDistribution, py::arg("scope"))
-    .def("outdegreeDistribution", &Graph::outdegreeDistribution, py::arg("scope"))
-    .def("sccSizeDistribution", &Graph::sccSizeDistribution)
-    .def("wccSizeDistribution", &Graph::wccSizeDistribution)
+    .def("distanceDistribution", [](Graph &self, const Scope scope, const double sample_fraction, const uint64_t seed){
+        return to_array(self.distanceDistribution(scope, sample_fraction, seed));
+    }, py::arg("scope"), py::arg("sample_fraction"), py::arg("seed") = 0)
+    .def("indegreeDistribution", [](Graph &self, const Scope scope){
+        return to_array(self.indegreeDistribution(scope));
+    }, py::arg("scope"))
+    .def("outdegreeDistribution", [](Graph &self, const Scope scope){
+        return to_array(self.outdegreeDistribution(scope));
+    }, py::arg("scope"))
+    .def("sccSizeDistribution", [](Graph &self){ return to_array(self.sccSizeDistribution()); })
+    .def("wccSizeDistribution", [](Graph &self){ return to_array(self.wccSizeDistribution()); })
 
     // distance metrics
     .def("distance", &Graph::distance, py::arg("node1_id"), py::arg("node2_id"))
+    .def("shortestPath", [](const Graph &self, const nodeindextype node1_id, const nodeindextype node2_id){
+        return to_array(self.shortestPath(node1_id, node2_id));
+    }, py::arg("node1_id"), py::arg("node2_id"))
     // .def("distances", &Graph::distances, (const int, vector<long> &);
-	.def("alldistances", &Graph::alldistances, py::arg("node_id"))
-    .def("averageDistance", &Graph::averageDistance, py::arg("scope"), py::arg("sample_fraction"));
+    .def("distances", [](const Graph &self, const std::vector< std::pair<nodeindextype, nodeindextype> > &pairs){
+        return to_array(self.distances(pairs));
+    }, py::arg("pairs"))
+	.def("alldistances", [](Graph &self, const nodeindextype node_id){
+        return to_array(self.alldistances(node_id));
+    }, py::arg("node_id"))
+    .def("averageDistance", &Graph::averageDistance, py::arg("scope"), py::arg("sample_fraction"), py::arg("seed") = 0)
+    .def("hyperBall", &Graph::hyperBall, py::arg("scope"), py::arg("bits") = 6)
+    .def("buildDistanceIndex", &Graph::buildDistanceIndex, py::arg("roots") = 16)
+    .def("loadDistanceIndex", &Graph::loadDistanceIndex, py::arg("filename"))
+    .def("saveDistanceIndex", &Graph::saveDistanceIndex, py::arg("filename"));
 
 /*
     // (node)list, distribution and stdout/binary output formats